@@ -0,0 +1,897 @@
+#include <cstring>
+
+#include "apu.h"
+#include "utils.h"
+
+// Which of the 8 steps of a square wave are high, for each duty (NRx1 bits 6-7)
+// 12.5%, 25%, 50% and 75%
+const Byte DUTY_PATTERNS[4] = {0x01, 0x81, 0x87, 0x7E};
+
+// The noise channel's timer is one of these shifted by NR43 bits 4-7
+const int NOISE_DIVISORS[8] = {8, 16, 32, 48, 64, 80, 96, 112};
+
+// What the unused bits of each register (and the write only ones) read as
+const Byte READ_MASKS[SOUND_CONTROL_ADDR - SOUND_REGISTERS_START + 1] = {
+    0x80, 0x3F, 0x00, 0xFF, 0xBF, // NR10 - NR14
+    0xFF, 0x3F, 0x00, 0xFF, 0xBF, // NR21 - NR24
+    0x7F, 0xFF, 0x9F, 0xFF, 0xBF, // NR30 - NR34
+    0xFF, 0xFF, 0x00, 0x00, 0xBF, // NR41 - NR44
+    0x00, 0x00, 0x70              // NR50 - NR52
+};
+
+// How much of the DC offset is kept each sample
+const float CAPACITOR_CHARGE = 0.996f;
+
+// Rate control works in -1 - 1 (the most it can slow down to the most it
+// can speed up)
+static double clampRate(double value)
+{
+    return value > 1 ? 1 : (value < -1 ? -1 : value);
+}
+
+void Apu::reset()
+{
+    // These are the values the boot ROM leaves in the registers
+    memset(this->registers, 0, sizeof(this->registers));
+    this->getRegister(0xFF10) = 0x80;
+    this->getRegister(0xFF11) = 0xBF;
+    this->getRegister(0xFF12) = 0xF3;
+    this->getRegister(0xFF14) = 0xBF;
+    this->getRegister(0xFF16) = 0x3F;
+    this->getRegister(0xFF17) = 0x00;
+    this->getRegister(0xFF19) = 0xBF;
+    this->getRegister(0xFF1A) = 0x7F;
+    this->getRegister(0xFF1B) = 0xFF;
+    this->getRegister(0xFF1E) = 0xBF;
+    this->getRegister(0xFF20) = 0xFF;
+    this->getRegister(0xFF21) = 0x00;
+    this->getRegister(0xFF22) = 0x00;
+    this->getRegister(0xFF23) = 0xBF;
+    this->getRegister(0xFF24) = 0x77;
+    this->getRegister(0xFF25) = 0xF3;
+    this->getRegister(0xFF26) = 0xF1;
+
+    // Nothing is playing yet
+    memset(this->channels, 0, sizeof(this->channels));
+    this->channels[3].lfsr = 0x7FFF;
+
+    this->lastClock = this->core->clock;
+    this->frameSequencerTimer = FRAME_SEQUENCER_CYCLES;
+    this->frameSequencerStep = 0;
+
+    this->droppedFrames = 0;
+    this->underrunFrames = 0;
+    this->resetFillStats();
+
+    // Back to the device's own rate
+    this->rateAdjustment = 1;
+    this->rateIntegral = 0;
+    this->setSampleRate(this->sampleRate);
+
+    this->frameStart = this->core->clock;
+    for (int side = 0; side < 2; side++)
+    {
+        this->buffers[side].clear();
+        this->amplitude[side] = 0;
+        this->capacitor[side] = 0;
+    }
+}
+
+RingBuffer<AudioFrame> *Apu::getOutput()
+{
+    return &(this->output);
+}
+
+unsigned long long Apu::getDroppedFrames()
+{
+    return this->droppedFrames;
+}
+
+Byte &Apu::getRegister(Word address)
+{
+    return this->registers[address - SOUND_REGISTERS_START];
+}
+
+Byte &Apu::getChannelRegister(int channel, int index)
+{
+    // Each channel has 5 registers (NRx0 - NRx4), even if it doesn't use NRx0
+    return this->registers[channel * 5 + index];
+}
+
+bool Apu::isPowered()
+{
+    return isBitSet(this->getRegister(SOUND_CONTROL_ADDR), 7);
+}
+
+bool Apu::isDacEnabled(int channel)
+{
+    // The wave channel has its own switch. The others are off when NRx2
+    // would make them silent and stay that way
+    if (channel == 2)
+    {
+        return isBitSet(this->getChannelRegister(2, 0), 7);
+    }
+
+    return (this->getChannelRegister(channel, 2) & 0xF8) != 0;
+}
+
+int Apu::getFrequency(int channel)
+{
+    // 11 bits, the low 8 in NRx3 and the high 3 in NRx4
+    return this->getChannelRegister(channel, 3) | ((this->getChannelRegister(channel, 4) & 0x7) << 8);
+}
+
+int Apu::getPeriod(int channel)
+{
+    // Cycles between each step through the waveform
+    switch (channel)
+    {
+        case 0:
+        case 1: return (2048 - this->getFrequency(channel)) * 4;
+        case 2: return (2048 - this->getFrequency(channel)) * 2;
+        default:
+        {
+            Byte polynomial = this->getChannelRegister(3, 3);
+            return NOISE_DIVISORS[polynomial & 0x7] << (polynomial >> 4);
+        }
+    }
+}
+
+Byte Apu::readRegister(Word address)
+{
+    this->update();
+
+    // Wave RAM reads back as written
+    if (address >= WAVE_RAM_START)
+    {
+        return this->getRegister(address);
+    }
+
+    // 0xFF27 - 0xFF2F aren't used
+    if (address > SOUND_CONTROL_ADDR)
+    {
+        return 0xFF;
+    }
+
+    // The low bits of NR52 say which channels are playing
+    if (address == SOUND_CONTROL_ADDR)
+    {
+        Byte status = this->getRegister(address) & 0x80;
+        for (int channel = 0; channel < 4; channel++)
+        {
+            if (this->channels[channel].enabled)
+            {
+                status |= 1 << channel;
+            }
+        }
+
+        return status | READ_MASKS[address - SOUND_REGISTERS_START];
+    }
+
+    return this->getRegister(address) | READ_MASKS[address - SOUND_REGISTERS_START];
+}
+
+void Apu::writeRegister(Word address, Byte data)
+{
+    // Whatever was playing up to now was playing with the old values, and
+    // whatever changed is a jump in the output from now
+    this->update();
+    this->storeRegister(address, data);
+    this->updateOutput();
+}
+
+void Apu::storeRegister(Word address, Byte data)
+{
+    if (address >= WAVE_RAM_START)
+    {
+        this->getRegister(address) = data;
+        return;
+    }
+
+    if (address > SOUND_CONTROL_ADDR)
+    {
+        return;
+    }
+
+    // Only bit 7 of NR52 can be written. Turning the sound off clears every
+    // register and stops every channel
+    if (address == SOUND_CONTROL_ADDR)
+    {
+        bool wasPowered = this->isPowered();
+        this->getRegister(address) = data & 0x80;
+
+        if (wasPowered && !this->isPowered())
+        {
+            memset(this->registers, 0, SOUND_CONTROL_ADDR - SOUND_REGISTERS_START);
+            for (int channel = 0; channel < 4; channel++)
+            {
+                this->channels[channel].enabled = false;
+            }
+        }
+        else if (!wasPowered && this->isPowered())
+        {
+            this->frameSequencerStep = 0;
+        }
+
+        return;
+    }
+
+    // While the sound is off the registers can't be written
+    if (!this->isPowered())
+    {
+        return;
+    }
+
+    this->getRegister(address) = data;
+
+    // NR50 and NR51 are only used by the mixer
+    if (address >= SOUND_REGISTERS_START + 20)
+    {
+        return;
+    }
+
+    int channel = (address - SOUND_REGISTERS_START) / 5;
+    int index = (address - SOUND_REGISTERS_START) % 5;
+    SoundChannel &state = this->channels[channel];
+
+    switch (index)
+    {
+        // The wave channel's DAC switch
+        case 0:
+        {
+            if (channel == 2 && !this->isDacEnabled(2))
+            {
+                state.enabled = false;
+            }
+
+            break;
+        }
+
+        // Writing the length loads the counter, which counts up to 64
+        // (or 256 for the wave channel)
+        case 1:
+        {
+            state.length = channel == 2 ? 256 - data : 64 - (data & 0x3F);
+            break;
+        }
+
+        case 2:
+        {
+            if (channel != 2 && !this->isDacEnabled(channel))
+            {
+                state.enabled = false;
+            }
+
+            break;
+        }
+
+        case 4:
+        {
+            if (isBitSet(data, 7))
+            {
+                this->trigger(channel);
+            }
+
+            break;
+        }
+
+        default: break;
+    }
+}
+
+void Apu::trigger(int channel)
+{
+    SoundChannel &state = this->channels[channel];
+
+    // A channel whose DAC is off can't be started
+    state.enabled = this->isDacEnabled(channel);
+
+    if (state.length == 0)
+    {
+        state.length = channel == 2 ? 256 : 64;
+    }
+
+    state.timer = this->getPeriod(channel);
+
+    if (channel == 2)
+    {
+        state.position = 0;
+    }
+    else
+    {
+        Byte envelope = this->getChannelRegister(channel, 2);
+        state.volume = envelope >> 4;
+        state.envelopeTimer = envelope & 0x7;
+    }
+
+    if (channel == 3)
+    {
+        state.lfsr = 0x7FFF;
+    }
+
+    // The sweep works from a copy of the frequency. If the first calculation
+    // would overflow the channel stops straight away
+    if (channel == 0)
+    {
+        Byte sweep = this->getChannelRegister(0, 0);
+        int period = (sweep >> 4) & 0x7;
+        int shift = sweep & 0x7;
+
+        state.shadowFrequency = this->getFrequency(0);
+        state.sweepTimer = period != 0 ? period : 8;
+        state.sweepEnabled = period != 0 || shift != 0;
+
+        if (shift != 0)
+        {
+            this->calculateSweep();
+        }
+    }
+}
+
+void Apu::update()
+{
+    // Run up to now, stopping whenever the frame sequencer needs clocking.
+    // In between, the only thing that changes is each channel moving through
+    // its waveform, and each time that changes its output it is a jump in
+    // the band-limited buffers
+    while (this->lastClock < this->core->clock)
+    {
+        unsigned long long remaining = this->core->clock - this->lastClock;
+        int cycles = this->frameSequencerTimer;
+        if (remaining < (unsigned long long) cycles)
+        {
+            cycles = (int) remaining;
+        }
+
+        this->run(cycles);
+        this->lastClock += cycles;
+
+        this->frameSequencerTimer -= cycles;
+        if (this->frameSequencerTimer == 0)
+        {
+            this->frameSequencerTimer = FRAME_SEQUENCER_CYCLES;
+            if (this->isPowered())
+            {
+                this->stepFrameSequencer();
+                this->updateOutput();
+            }
+
+            // This keeps what is in the buffers down to a step's worth
+            this->flush();
+        }
+    }
+
+    this->flush();
+}
+
+void Apu::setSampleRate(int sampleRate)
+{
+    this->sampleRate = sampleRate;
+    for (int side = 0; side < 2; side++)
+    {
+        this->buffers[side].setRate(CLOCK_SPEED, sampleRate * this->rateAdjustment);
+    }
+}
+
+void Apu::controlRate()
+{
+    // Frames are paced by the host's timer but the samples are played by the
+    // sound card's clock, which never quite agree. If the buffer is running
+    // low, make samples a little faster, and a little slower if it is
+    // filling up, in proportion to how far off the target it is. Anything
+    // that is off for a while (the clocks drifting steadily apart) builds up
+    // in the integral until it is taken out. Up to 0.5% can't be heard as a
+    // change in pitch, and keeps the buffer small without it ever running
+    // dry or overflowing.
+    //
+    // This is called before the frame is run, so the fill is the lowest the
+    // buffer gets - only the device has taken samples since the last frame
+    size_t fill = this->output.size();
+    double error = ((double) AUDIO_TARGET_FRAMES - (double) fill) / AUDIO_TARGET_FRAMES;
+    error = clampRate(error);
+
+    this->rateIntegral = clampRate(this->rateIntegral + error * AUDIO_RATE_INTEGRAL_GAIN);
+    this->rateAdjustment = 1 + AUDIO_MAX_RATE_ADJUSTMENT * clampRate(error + this->rateIntegral);
+    this->setSampleRate(this->sampleRate);
+
+    if (this->fillCount == 0 || fill < this->minimumFill)
+    {
+        this->minimumFill = fill;
+    }
+
+    if (this->fillCount == 0 || fill > this->maximumFill)
+    {
+        this->maximumFill = fill;
+    }
+
+    this->totalFill += fill;
+    this->fillCount++;
+}
+
+void Apu::readOutput(AudioFrame *frames, size_t count)
+{
+    // If the emulator is behind, play silence for whatever is missing
+    size_t taken = this->output.pop(frames, count);
+    if (taken < count)
+    {
+        memset(frames + taken, 0, (count - taken) * sizeof(AudioFrame));
+        this->underrunFrames.fetch_add(count - taken, std::memory_order_relaxed);
+    }
+}
+
+AudioStats Apu::takeAudioStats()
+{
+    AudioStats stats;
+    stats.minimumFill = this->minimumFill;
+    stats.maximumFill = this->maximumFill;
+    stats.averageFill = this->fillCount > 0 ? (double) this->totalFill / this->fillCount : 0;
+
+    // A sample waits behind what is in the buffer, which on average is the
+    // lowest it gets plus half a frame, then behind what the device has
+    // already taken (half of a request on average)
+    double frameSamples = (double) this->sampleRate * MAX_CYCLES_PER_FRAME / CLOCK_SPEED;
+    stats.latencyMs = (stats.averageFill + frameSamples / 2 + AUDIO_DEVICE_FRAMES / 2.0) * 1000 / this->sampleRate;
+
+    stats.rateAdjustment = this->rateAdjustment;
+    stats.underrunFrames = this->underrunFrames.load(std::memory_order_relaxed);
+    stats.droppedFrames = this->droppedFrames;
+
+    this->resetFillStats();
+    return stats;
+}
+
+void Apu::resetFillStats()
+{
+    this->minimumFill = 0;
+    this->maximumFill = 0;
+    this->totalFill = 0;
+    this->fillCount = 0;
+}
+
+int Apu::advanceTimer(SoundChannel &channel, int cycles, int period)
+{
+    // Returns how many times the timer ran out (and was reloaded with the
+    // period) in the given cycles
+    if (channel.timer > cycles)
+    {
+        channel.timer -= cycles;
+        return 0;
+    }
+
+    int over = cycles - channel.timer;
+    channel.timer = period - over % period;
+    return 1 + over / period;
+}
+
+void Apu::run(int cycles)
+{
+    int start = this->lastClock - this->frameStart;
+
+    for (int channel = 0; channel < 4; channel++)
+    {
+        SoundChannel &state = this->channels[channel];
+        if (!state.enabled)
+        {
+            continue;
+        }
+
+        int period = this->getPeriod(channel);
+
+        // A square or wave channel at volume 0 can't be heard wherever it
+        // is in its waveform, so it is moved on in one go
+        if (this->isSilent(channel))
+        {
+            int steps = this->advanceTimer(state, cycles, period);
+            state.position = (state.position + steps) % (channel == 2 ? 32 : 8);
+            continue;
+        }
+
+        // Otherwise each step is a possible jump in the output. Nothing can
+        // change the mixer until the next register write
+        int gains[2] = { this->getGain(channel, 0), this->getGain(channel, 1) };
+        int elapsed = 0;
+        while (state.timer <= cycles - elapsed)
+        {
+            elapsed += state.timer;
+            state.timer = period;
+
+            this->stepWaveform(channel);
+            this->setOutput(channel, this->getDacOutput(channel), start + elapsed, gains);
+        }
+
+        state.timer -= cycles - elapsed;
+    }
+}
+
+void Apu::stepWaveform(int channel)
+{
+    SoundChannel &state = this->channels[channel];
+
+    switch (channel)
+    {
+        case 0:
+        case 1: state.position = (state.position + 1) % 8; break;
+        case 2: state.position = (state.position + 1) % 32; break;
+
+        // Each step of the noise channel shifts the LFSR. Bit 0 xor bit 1
+        // goes into bit 14 (and bit 6 too in 7-bit mode)
+        default:
+        {
+            int bit = (state.lfsr ^ (state.lfsr >> 1)) & 1;
+            state.lfsr = (state.lfsr >> 1) | (bit << 14);
+            if (isBitSet(this->getChannelRegister(3, 3), 3))
+            {
+                state.lfsr = (state.lfsr & ~0x40) | (bit << 6);
+            }
+
+            break;
+        }
+    }
+}
+
+bool Apu::isSilent(int channel)
+{
+    switch (channel)
+    {
+        case 0:
+        case 1: return this->channels[channel].volume == 0;
+        case 2: return ((this->getChannelRegister(2, 2) >> 5) & 0x3) == 0;
+
+        // The noise channel's LFSR has to be run step by step anyway
+        default: return false;
+    }
+}
+
+void Apu::stepFrameSequencer()
+{
+    // Step:   0 1 2 3 4 5 6 7
+    // Length: x   x   x   x
+    // Sweep:      x       x
+    // Volume:               x
+    if (this->frameSequencerStep % 2 == 0)
+    {
+        this->clockLength();
+    }
+
+    if (this->frameSequencerStep == 2 || this->frameSequencerStep == 6)
+    {
+        this->clockSweep();
+    }
+
+    if (this->frameSequencerStep == 7)
+    {
+        this->clockEnvelope();
+    }
+
+    this->frameSequencerStep = (this->frameSequencerStep + 1) % 8;
+}
+
+void Apu::clockLength()
+{
+    // The length counter only stops the channel when NRx4 bit 6 is set
+    for (int channel = 0; channel < 4; channel++)
+    {
+        SoundChannel &state = this->channels[channel];
+        if (isBitSet(this->getChannelRegister(channel, 4), 6) && state.length > 0)
+        {
+            state.length--;
+            if (state.length == 0)
+            {
+                state.enabled = false;
+            }
+        }
+    }
+}
+
+void Apu::clockSweep()
+{
+    SoundChannel &state = this->channels[0];
+    if (--state.sweepTimer > 0)
+    {
+        return;
+    }
+
+    Byte sweep = this->getChannelRegister(0, 0);
+    int period = (sweep >> 4) & 0x7;
+    int shift = sweep & 0x7;
+    state.sweepTimer = period != 0 ? period : 8;
+
+    if (!state.sweepEnabled || period == 0)
+    {
+        return;
+    }
+
+    // The new frequency is written back to NR13 and NR14, then worked out
+    // again just to check that it won't overflow next time
+    int frequency = this->calculateSweep();
+    if (frequency <= 2047 && shift != 0)
+    {
+        state.shadowFrequency = frequency;
+        this->getChannelRegister(0, 3) = frequency & 0xFF;
+        this->getChannelRegister(0, 4) = (this->getChannelRegister(0, 4) & 0xF8) | ((frequency >> 8) & 0x7);
+        this->calculateSweep();
+    }
+}
+
+int Apu::calculateSweep()
+{
+    // The frequency moves up or down (NR10 bit 3) by itself shifted right.
+    // Going over 2047 stops the channel
+    SoundChannel &state = this->channels[0];
+    Byte sweep = this->getChannelRegister(0, 0);
+
+    int change = state.shadowFrequency >> (sweep & 0x7);
+    int frequency = isBitSet(sweep, 3) ? state.shadowFrequency - change : state.shadowFrequency + change;
+
+    if (frequency > 2047)
+    {
+        state.enabled = false;
+    }
+
+    return frequency;
+}
+
+void Apu::clockEnvelope()
+{
+    // Every (NRx2 & 7) clocks the volume goes up or down (NRx2 bit 3) by
+    // one, until it can't go any further. A period of 0 stops it
+    for (int channel = 0; channel < 4; channel++)
+    {
+        if (channel == 2)
+        {
+            continue;
+        }
+
+        SoundChannel &state = this->channels[channel];
+        Byte envelope = this->getChannelRegister(channel, 2);
+        int period = envelope & 0x7;
+        if (period == 0 || --state.envelopeTimer > 0)
+        {
+            continue;
+        }
+
+        state.envelopeTimer = period;
+        if (isBitSet(envelope, 3) && state.volume < 15)
+        {
+            state.volume++;
+        }
+        else if (!isBitSet(envelope, 3) && state.volume > 0)
+        {
+            state.volume--;
+        }
+    }
+}
+
+int Apu::getLevel(int channel)
+{
+    SoundChannel &state = this->channels[channel];
+
+    switch (channel)
+    {
+        case 0:
+        case 1:
+        {
+            Byte duty = DUTY_PATTERNS[this->getChannelRegister(channel, 1) >> 6];
+            return ((duty >> state.position) & 1) ? state.volume : 0;
+        }
+
+        // 32 4-bit samples, high nibble first. NR32 bits 5-6 pick the volume:
+        // mute, 100%, 50% or 25%
+        case 2:
+        {
+            int volume = (this->getChannelRegister(2, 2) >> 5) & 0x3;
+            if (volume == 0)
+            {
+                return 0;
+            }
+
+            Byte samples = this->getRegister(WAVE_RAM_START + state.position / 2);
+            int sample = state.position % 2 == 0 ? samples >> 4 : samples & 0xF;
+            return sample >> (volume - 1);
+        }
+
+        // The output is high when bit 0 of the LFSR is low
+        default: return (state.lfsr & 1) ? 0 : state.volume;
+    }
+}
+
+int Apu::getDacOutput(int channel)
+{
+    // Each channel's DAC turns its level (0 - 15) into -15 - 15. A channel
+    // that isn't playing (or whose DAC is off) adds nothing
+    if (!this->channels[channel].enabled || !this->isDacEnabled(channel))
+    {
+        return 0;
+    }
+
+    return this->getLevel(channel) * 2 - 15;
+}
+
+int Apu::getGain(int channel, int side)
+{
+    // NR51 puts each channel on the right (bits 0-3) and left (bits 4-7),
+    // and NR50 sets the volume of each side from 1 - 8
+    Byte panning = this->getRegister(0xFF25);
+    Byte volume = this->getRegister(0xFF24);
+
+    if (side == 0)
+    {
+        return isBitSet(panning, channel + 4) ? ((volume >> 4) & 0x7) + 1 : 0;
+    }
+
+    return isBitSet(panning, channel) ? (volume & 0x7) + 1 : 0;
+}
+
+void Apu::setOutput(int channel, int output, int time, const int *gains)
+{
+    // Only the channel that changed needs to go into the jump. The mixer is
+    // just a sum, so its jump on each side is the channel's scaled by its gain
+    SoundChannel &state = this->channels[channel];
+    int delta = output - state.output;
+    if (delta == 0)
+    {
+        return;
+    }
+
+    state.output = output;
+    for (int side = 0; side < 2; side++)
+    {
+        if (gains[side] != 0)
+        {
+            this->amplitude[side] += delta * gains[side];
+            this->buffers[side].addDelta(time, (float) (delta * gains[side]));
+        }
+    }
+}
+
+void Apu::updateOutput()
+{
+    // Anything other than a channel stepping (a register write or the frame
+    // sequencer) might have changed any channel, or the mixer itself, so the
+    // whole mix is worked out again
+    int time = this->lastClock - this->frameStart;
+
+    for (int channel = 0; channel < 4; channel++)
+    {
+        this->channels[channel].output = this->getDacOutput(channel);
+    }
+
+    for (int side = 0; side < 2; side++)
+    {
+        int amplitude = 0;
+        for (int channel = 0; channel < 4; channel++)
+        {
+            amplitude += this->channels[channel].output * this->getGain(channel, side);
+        }
+
+        if (amplitude != this->amplitude[side])
+        {
+            this->buffers[side].addDelta(time, (float) (amplitude - this->amplitude[side]));
+            this->amplitude[side] = amplitude;
+        }
+    }
+}
+
+void Apu::flush()
+{
+    // Everything up to now has been added to the buffers, so the samples
+    // before now are finished
+    int time = this->lastClock - this->frameStart;
+    this->frameStart = this->lastClock;
+
+    float samples[2][BLIP_BUFFER_SAMPLES];
+    int count = 0;
+    for (int side = 0; side < 2; side++)
+    {
+        this->buffers[side].endFrame(time);
+        count = this->buffers[side].getSamplesAvailable();
+        this->buffers[side].readSamples(samples[side], count);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        // The largest the mix can be is 4 channels * 15 * 8 = 480, so it is
+        // scaled up to most of the 16-bit range
+        SignedWord frame[2];
+        for (int side = 0; side < 2; side++)
+        {
+            float filtered = samples[side][i] - this->capacitor[side];
+            this->capacitor[side] = samples[side][i] - filtered * CAPACITOR_CHARGE;
+
+            float scaled = filtered * 64;
+            if (scaled > 32767)
+            {
+                scaled = 32767;
+            }
+            else if (scaled < -32768)
+            {
+                scaled = -32768;
+            }
+
+            frame[side] = (SignedWord) scaled;
+        }
+
+        if (!this->outputEnabled)
+        {
+            continue;
+        }
+
+        // If the audio device isn't keeping up the sample is dropped, rather
+        // than waiting for it
+        if (!this->output.push({frame[0], frame[1]}))
+        {
+            this->droppedFrames++;
+        }
+    }
+}
+
+void Apu::setOutputEnabled(bool enabled)
+{
+    this->outputEnabled = enabled;
+}
+
+void Apu::saveState(StateWriter &state)
+{
+    state.write(this->registers, sizeof(this->registers));
+
+    for (int i = 0; i < 4; i++)
+    {
+        SoundChannel &channel = this->channels[i];
+        state.put(channel.enabled);
+        state.put(channel.timer);
+        state.put(channel.position);
+        state.put(channel.length);
+        state.put(channel.volume);
+        state.put(channel.envelopeTimer);
+        state.put(channel.sweepTimer);
+        state.put(channel.shadowFrequency);
+        state.put(channel.sweepEnabled);
+        state.put(channel.lfsr);
+        state.put(channel.output);
+    }
+
+    state.put(this->lastClock);
+    state.put(this->frameSequencerTimer);
+    state.put(this->frameSequencerStep);
+    state.put(this->frameStart);
+
+    for (int side = 0; side < 2; side++)
+    {
+        this->buffers[side].saveState(state);
+        state.put(this->amplitude[side]);
+        state.putFloat(this->capacitor[side]);
+    }
+}
+
+void Apu::loadState(StateReader &state)
+{
+    state.read(this->registers, sizeof(this->registers));
+
+    for (int i = 0; i < 4; i++)
+    {
+        SoundChannel &channel = this->channels[i];
+        state.get(channel.enabled);
+        state.get(channel.timer);
+        state.get(channel.position);
+        state.get(channel.length);
+        state.get(channel.volume);
+        state.get(channel.envelopeTimer);
+        state.get(channel.sweepTimer);
+        state.get(channel.shadowFrequency);
+        state.get(channel.sweepEnabled);
+        state.get(channel.lfsr);
+        state.get(channel.output);
+    }
+
+    state.get(this->lastClock);
+    state.get(this->frameSequencerTimer);
+    state.get(this->frameSequencerStep);
+    state.get(this->frameStart);
+
+    for (int side = 0; side < 2; side++)
+    {
+        this->buffers[side].loadState(state);
+        state.get(this->amplitude[side]);
+        state.getFloat(this->capacitor[side]);
+    }
+}
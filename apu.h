@@ -0,0 +1,221 @@
+/**
+ *
+ * AUDIO PROCESSING UNIT
+ * The Gameboy has 4 sound channels, each of which makes a level from 0 - 15:
+ *  1. Square wave with a frequency sweep (NR10 - NR14)
+ *  2. Square wave (NR21 - NR24)
+ *  3. Wave, playing 32 4-bit samples from wave RAM (NR30 - NR34)
+ *  4. Noise, from a linear feedback shift register (NR41 - NR44)
+ *
+ * Each channel steps through its waveform on a timer set by its frequency,
+ * and can be stopped by a length counter. The frame sequencer (512 Hz) clocks
+ * the length counters, channel 1's sweep (128 Hz) and the volume envelopes of
+ * channels 1, 2 and 4 (64 Hz). The mixer (NR50 - NR52) puts each channel on
+ * the left and/or right and sets the volume of each side.
+ *
+ * The APU doesn't run alongside the CPU. It keeps the cycle it has run up to,
+ * and catches up to the current cycle when a sound register is read or
+ * written (so it always sees the registers as they were) and at the end of
+ * each frame. Catching up runs each channel through its waveform, and each
+ * time a channel's output changes that jump goes into a band-limited buffer
+ * for each side (see blipbuffer.h), which turns the jumps into samples at
+ * the output rate. The cost is in the number of jumps rather than the
+ * number of cycles, and a channel that can't be heard skips its waveform in
+ * one go.
+ *
+ * Samples go into a ring buffer (see ringbuffer.h) which the audio device
+ * takes them from on its own thread, so emulation never waits for audio
+ *
+ **/
+
+#ifndef __APU_H_INCLUDED__
+#define __APU_H_INCLUDED__
+
+#include <atomic>
+
+#include "blipbuffer.h"
+#include "core.h"
+#include "ringbuffer.h"
+#include "savestate.h"
+#include "utils.h"
+
+// One 16-bit stereo sample
+struct AudioFrame {
+    SignedWord left;
+    SignedWord right;
+};
+
+// The state of a channel that isn't in its registers. Not every channel uses
+// every field (i.e. only channel 1 has a sweep)
+struct SoundChannel {
+    bool enabled;
+
+    // Cycles until the waveform moves on, and where it is in the waveform
+    int timer;
+    int position;
+
+    int length;
+
+    // Volume envelope
+    int volume;
+    int envelopeTimer;
+
+    // Channel 1's frequency sweep
+    int sweepTimer;
+    int shadowFrequency;
+    bool sweepEnabled;
+
+    // Channel 4's shift register
+    Word lfsr;
+
+    // What the channel's DAC is putting out (-15 - 15)
+    int output;
+};
+
+// How the buffer between the emulator and the audio device has been doing
+// since the last time these were taken (see Apu::takeAudioStats)
+struct AudioStats {
+    // The buffer just before each frame is made, when it is at its lowest
+    size_t minimumFill;
+    size_t maximumFill;
+    double averageFill;
+
+    // How long a sample made now waits before it is played, on average
+    double latencyMs;
+
+    // What the output rate was last nudged by (1 is not at all)
+    double rateAdjustment;
+
+    // Since the APU was reset
+    unsigned long long underrunFrames;
+    unsigned long long droppedFrames;
+};
+
+class Apu {
+
+    public:
+        Apu(Core *_core) : core(_core), output(AUDIO_BUFFER_FRAMES) {};
+
+        void reset();
+
+        // 0xFF10 - 0xFF3F
+        Byte readRegister(Word address);
+        void writeRegister(Word address, Byte data);
+
+        // Run the channels up to the current clock, and put the samples
+        // up to it in the output
+        void update();
+
+        // The rate the output is made at (AUDIO_SAMPLE_RATE unless the audio
+        // device wants another)
+        void setSampleRate(int sampleRate);
+
+        // Nudge the output rate to keep the buffer near AUDIO_TARGET_FRAMES.
+        // Called once a frame, before it is run, while an audio device is
+        // playing the output
+        void controlRate();
+
+        // Where samples are put for the audio device (see ringbuffer.h)
+        RingBuffer<AudioFrame> *getOutput();
+
+        // Called by the audio device (on its own thread) to take count
+        // samples. If there aren't enough the rest are silence
+        void readOutput(AudioFrame *frames, size_t count);
+
+        // Samples that were dropped because nothing took them out of the buffer
+        unsigned long long getDroppedFrames();
+
+        AudioStats takeAudioStats();
+
+        // While the output is off, samples are made as usual but thrown away
+        // (for frames that are run ahead and thrown away)
+        void setOutputEnabled(bool enabled);
+
+        // The registers, channels and what hasn't been output yet. The output
+        // buffer, its rate and the stats belong to the audio device
+        void saveState(StateWriter &state);
+        void loadState(StateReader &state);
+
+    private:
+        // The clock is in the core block
+        Core *core;
+
+        Byte registers[SOUND_REGISTERS_END - SOUND_REGISTERS_START + 1];
+        SoundChannel channels[4];
+
+        // The cycle the APU has run up to
+        unsigned long long lastClock = 0;
+
+        int frameSequencerTimer = FRAME_SEQUENCER_CYCLES;
+        int frameSequencerStep = 0;
+
+        // The jumps in the output of each side since frameStart on the clock,
+        // and the amplitude the mix is at (the sum of all of the jumps)
+        BlipBuffer buffers[2];
+        unsigned long long frameStart = 0;
+        int amplitude[2] = {};
+
+        // The DC offset is taken out of each side like the capacitor on the
+        // hardware output does
+        float capacitor[2] = {};
+
+        RingBuffer<AudioFrame> output;
+        unsigned long long droppedFrames = 0;
+        bool outputEnabled = true;
+
+        // Written by the audio thread
+        std::atomic<unsigned long long> underrunFrames{0};
+
+        // The rate the device plays at, and what controlRate has nudged it by.
+        // rateIntegral is the error built up over time
+        int sampleRate = AUDIO_SAMPLE_RATE;
+        double rateAdjustment = 1;
+        double rateIntegral = 0;
+
+        // The buffer fill each time controlRate was called (for AudioStats)
+        size_t minimumFill = 0;
+        size_t maximumFill = 0;
+        unsigned long long totalFill = 0;
+        int fillCount = 0;
+
+        void resetFillStats();
+
+        void storeRegister(Word address, Byte data);
+
+        Byte &getRegister(Word address);
+        Byte &getChannelRegister(int channel, int index);
+        bool isPowered();
+        bool isDacEnabled(int channel);
+        int getFrequency(int channel);
+        int getPeriod(int channel);
+
+        void run(int cycles);
+        int advanceTimer(SoundChannel &channel, int cycles, int period);
+        void stepWaveform(int channel);
+        bool isSilent(int channel);
+
+        void stepFrameSequencer();
+        void clockLength();
+        void clockSweep();
+        void clockEnvelope();
+        int calculateSweep();
+
+        void trigger(int channel);
+
+        // Level (0 - 15) of a channel right now
+        int getLevel(int channel);
+        int getDacOutput(int channel);
+
+        // How much of a channel goes to each side (0 is left, 1 is right)
+        int getGain(int channel, int side);
+
+        // Add the jump when a channel's output changes (with the gains of
+        // each side), or when anything about the mix might have changed
+        void setOutput(int channel, int output, int time, const int *gains);
+        void updateOutput();
+
+        // Turn the jumps up to now into samples in the output
+        void flush();
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+#include <sys/mman.h>
+
+#include "arena.h"
+#include "utils.h"
+
+using namespace std;
+
+Arena::Arena(size_t capacity, bool useHugePages)
+{
+    void *mapping = MAP_FAILED;
+
+    if (useHugePages)
+    {
+        // Explicit huge pages need the size to be a multiple of the huge page size
+        // and only work if the system has some reserved, so fall back if it fails
+        size_t hugeCapacity = (capacity + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        mapping = mmap(NULL, hugeCapacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mapping != MAP_FAILED)
+        {
+            capacity = hugeCapacity;
+            this->hugePages = true;
+        }
+    }
+
+    if (mapping == MAP_FAILED)
+    {
+        mapping = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED)
+        {
+            throw bad_alloc();
+        }
+
+        // Transparent huge pages are the next best thing
+        if (useHugePages)
+        {
+            madvise(mapping, capacity, MADV_HUGEPAGE);
+        }
+    }
+
+    this->base = (Byte *) mapping;
+    this->capacity = capacity;
+}
+
+Arena::~Arena()
+{
+    // Destroy everything in the reverse order it was created, as later
+    // objects can point at earlier ones
+    for (auto it = this->destructors.rbegin(); it != this->destructors.rend(); it++)
+    {
+        it->second(it->first);
+    }
+
+    munmap(this->base, this->capacity);
+}
+
+void *Arena::allocate(size_t size, size_t alignment)
+{
+    size_t start = (this->used + alignment - 1) & ~(alignment - 1);
+    if (start + size > this->capacity)
+    {
+        return NULL;
+    }
+
+    this->used = start + size;
+    return this->base + start;
+}
+
+size_t Arena::getUsed()
+{
+    return this->used;
+}
+
+bool Arena::isUsingHugePages()
+{
+    return this->hugePages;
+}
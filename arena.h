@@ -0,0 +1,70 @@
+/**
+ *
+ * ARENA
+ * A simple bump allocator for emulator instances. Everything an instance needs
+ * (the core block, Cpu, Mmu, Display) is allocated next to each other, and when
+ * running many instances from one arena they are all packed into the same
+ * region. The region can optionally be backed by huge pages, which cuts down
+ * TLB misses when a core switches between lots of instances
+ *
+ * Objects are never freed individually - they are destroyed (in reverse order)
+ * when the arena is
+ *
+ **/
+
+#ifndef __ARENA_H_INCLUDED__
+#define __ARENA_H_INCLUDED__
+
+#include <stddef.h>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "utils.h"
+
+class Arena {
+
+    public:
+        Arena(size_t capacity, bool useHugePages = false);
+        ~Arena();
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        // Returns NULL if the arena is full
+        void *allocate(size_t size, size_t alignment);
+
+        // Construct an object in the arena. It will be destroyed with the arena
+        template <typename T, typename... Args>
+        T *create(Args&&... args)
+        {
+            void *memory = this->allocate(sizeof(T), alignof(T));
+            if (memory == NULL)
+            {
+                throw std::bad_alloc();
+            }
+
+            T *object = new (memory) T(std::forward<Args>(args)...);
+            this->destructors.push_back(std::make_pair((void *) object, &Arena::destroy<T>));
+            return object;
+        }
+
+        size_t getUsed();
+        bool isUsingHugePages();
+
+    private:
+        Byte *base = NULL;
+        size_t capacity = 0;
+        size_t used = 0;
+        bool hugePages = false;
+
+        std::vector<std::pair<void *, void (*)(void *)>> destructors;
+
+        template <typename T>
+        static void destroy(void *object)
+        {
+            ((T *) object)->~T();
+        }
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include <cstring>
+
+#include "bgcache.h"
+#include "utils.h"
+
+BackgroundCache::BackgroundCache()
+{
+    this->pixels.resize(2 * BACKGROUND_MAP_SIZE * BACKGROUND_MAP_SIZE, 0);
+    this->invalidate();
+}
+
+void BackgroundCache::invalidate()
+{
+    for (int map = 0; map < 2; map++)
+    {
+        memset(this->dirtyEntries[map], true, sizeof(this->dirtyEntries[map]));
+        memset(this->dirtyTiles[map], false, sizeof(this->dirtyTiles[map]));
+        this->entriesDirty[map] = true;
+        this->tilesDirty[map] = false;
+    }
+}
+
+void BackgroundCache::videoMemoryWritten(Word address)
+{
+    int offset = address - VIDEO_RAM_START;
+    if (offset < 0 || offset >= VIDEO_RAM_SIZE)
+    {
+        return;
+    }
+
+    if (offset < TILE_DATA_SIZE)
+    {
+        // A tile changed, which could be used anywhere in either map. We find
+        // out where when the cache is next updated
+        int tile = offset / 16;
+        for (int map = 0; map < 2; map++)
+        {
+            this->dirtyTiles[map][tile] = true;
+            this->tilesDirty[map] = true;
+        }
+    }
+    else
+    {
+        // An entry in one of the maps changed
+        int map = (offset - TILE_DATA_SIZE) / BACKGROUND_MAP_TILES;
+        this->dirtyEntries[map][(offset - TILE_DATA_SIZE) % BACKGROUND_MAP_TILES] = true;
+        this->entriesDirty[map] = true;
+    }
+}
+
+void BackgroundCache::update(const Byte *videoRam, const TileCache *tileCache, bool isUnsigned)
+{
+    // Every entry reads its tile differently if the tile numbering changed
+    if (this->unsignedTiles != isUnsigned)
+    {
+        this->invalidate();
+        this->unsignedTiles = isUnsigned;
+    }
+
+    for (int map = 0; map < 2; map++)
+    {
+        const Byte *tileMap = videoRam + TILE_DATA_SIZE + map * BACKGROUND_MAP_TILES;
+
+        // Find the entries using tiles that changed
+        if (this->tilesDirty[map])
+        {
+            for (int entry = 0; entry < BACKGROUND_MAP_TILES; entry++)
+            {
+                int tile = isUnsigned ? tileMap[entry] : 256 + (SignedByte) tileMap[entry];
+                if (this->dirtyTiles[map][tile])
+                {
+                    this->dirtyEntries[map][entry] = true;
+                    this->entriesDirty[map] = true;
+                }
+            }
+
+            memset(this->dirtyTiles[map], false, sizeof(this->dirtyTiles[map]));
+            this->tilesDirty[map] = false;
+        }
+
+        if (!this->entriesDirty[map])
+        {
+            continue;
+        }
+
+        // Draw each dirty entry, a tile line at a time
+        for (int entry = 0; entry < BACKGROUND_MAP_TILES; entry++)
+        {
+            if (!this->dirtyEntries[map][entry])
+            {
+                continue;
+            }
+
+            int tile = isUnsigned ? tileMap[entry] : 256 + (SignedByte) tileMap[entry];
+            int x = (entry % 32) * 8;
+            int y = (entry / 32) * 8;
+            for (int line = 0; line < 8; line++)
+            {
+                Byte *row = this->pixels.data() + (map * BACKGROUND_MAP_SIZE + y + line) * BACKGROUND_MAP_SIZE;
+                memcpy(row + x, tileCache->getLine(tile, line), 8);
+            }
+
+            this->dirtyEntries[map][entry] = false;
+        }
+
+        this->entriesDirty[map] = false;
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ *
+ * BACKGROUND CACHE
+ * Each tile map (0x9800 and 0x9C00) describes a 256x256 pixel image, and a
+ * lot of games scroll around a map that hardly changes. Rather than build
+ * each line of the background from tiles, this keeps both maps drawn out as
+ * color indices (0 - 3), so a line is a copy (wrapping around at 256) from
+ * (SCX, SCY + LY).
+ *
+ * Writes to VRAM mark the map entries (or tiles) they change as dirty, and
+ * only dirty entries are drawn again when the cache is brought up to date.
+ * The map depends on how tile numbers are read (LCDC bit 4), so if that
+ * changes the whole map is drawn again
+ *
+ **/
+
+#ifndef __BGCACHE_H_INCLUDED__
+#define __BGCACHE_H_INCLUDED__
+
+#include <vector>
+
+#include "tilecache.h"
+#include "utils.h"
+
+class BackgroundCache {
+
+    public:
+        BackgroundCache();
+
+        // Mark everything dirty (i.e. when all of VRAM is reset)
+        void invalidate();
+
+        // VRAM at address is being written
+        void videoMemoryWritten(Word address);
+
+        // Draw any dirty map entries, reading tile numbers as unsigned or not
+        void update(const Byte *videoRam, const TileCache *tileCache, bool isUnsigned);
+
+        // A row of 256 color indices from map 0 (0x9800) or 1 (0x9C00), only
+        // valid for the tile numbering the cache was last updated with
+        const Byte *getRow(int map, Byte y) const
+        {
+            return this->pixels.data() + (map * BACKGROUND_MAP_SIZE + y) * BACKGROUND_MAP_SIZE;
+        }
+
+        bool isUnsigned()
+        {
+            return this->unsignedTiles;
+        }
+
+    private:
+        // Both maps, 256x256 each
+        std::vector<Byte> pixels;
+
+        bool unsignedTiles = true;
+
+        // Map entries that need to be drawn again, and tiles that have
+        // changed (which every entry using them needs to be drawn again)
+        bool dirtyEntries[2][BACKGROUND_MAP_TILES];
+        bool dirtyTiles[2][TILE_COUNT];
+        bool entriesDirty[2];
+        bool tilesDirty[2];
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "blipbuffer.h"
+#include "utils.h"
+
+// The filter passes up to this fraction of the highest frequency the sample
+// rate can carry, leaving the rest of the way for it to roll off
+const double BLIP_CUTOFF = 0.9;
+
+/* -------------------------Kernel--------------------------- */
+
+struct BlipKernel {
+    alignas(CACHE_LINE_SIZE) float phases[BLIP_KERNEL_PHASES][BLIP_KERNEL_WIDTH];
+
+    BlipKernel()
+    {
+        // Each phase is a windowed sinc centered (BLIP_KERNEL_WIDTH / 2 - 1)
+        // samples plus the phase's fraction of a sample in. They are scaled
+        // to add up to 1, so a jump comes out as exactly that jump
+        const double pi = 3.14159265358979323846;
+        for (int phase = 0; phase < BLIP_KERNEL_PHASES; phase++)
+        {
+            double fraction = (double) phase / BLIP_KERNEL_PHASES;
+            double sum = 0;
+            double taps[BLIP_KERNEL_WIDTH];
+
+            for (int i = 0; i < BLIP_KERNEL_WIDTH; i++)
+            {
+                double x = i - (BLIP_KERNEL_WIDTH / 2 - 1) - fraction;
+                double sinc = x == 0 ? 1 : sin(pi * BLIP_CUTOFF * x) / (pi * BLIP_CUTOFF * x);
+
+                // Blackman window over the width of the kernel
+                double w = 2 * pi * x / BLIP_KERNEL_WIDTH;
+                double window = 0.42 + 0.5 * cos(w) + 0.08 * cos(2 * w);
+
+                taps[i] = sinc * window;
+                sum += taps[i];
+            }
+
+            for (int i = 0; i < BLIP_KERNEL_WIDTH; i++)
+            {
+                this->phases[phase][i] = (float) (taps[i] / sum);
+            }
+        }
+    }
+};
+
+static const BlipKernel &getKernel()
+{
+    static const BlipKernel kernel;
+    return kernel;
+}
+
+// Adding the kernel is the inner loop. SSE2 is always there on x86-64 (and
+// __SSE2__ says so at compile time), so it is used without checking the CPU
+// or the optimisation level. Elsewhere it is a plain loop
+#ifdef __SSE2__
+
+static_assert(BLIP_KERNEL_WIDTH % 4 == 0, "The kernel is added 4 floats at a time");
+
+static inline void addKernel(float *out, const float *kernel, float delta)
+{
+    // The kernel is 16 wide, so this is 4 of 4 floats. Each phase is 64
+    // bytes into a cache line aligned table so the kernel is aligned, but
+    // the output isn't as jumps land on any sample
+    const __m128 scale = _mm_set1_ps(delta);
+    for (int i = 0; i < BLIP_KERNEL_WIDTH; i += 4)
+    {
+        __m128 step = _mm_mul_ps(_mm_load_ps(kernel + i), scale);
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), step));
+    }
+}
+
+#else
+
+static inline void addKernel(float *out, const float *kernel, float delta)
+{
+    for (int i = 0; i < BLIP_KERNEL_WIDTH; i++)
+    {
+        out[i] += kernel[i] * delta;
+    }
+}
+
+#endif
+
+/* -------------------------Buffer--------------------------- */
+
+BlipBuffer::BlipBuffer()
+{
+    // Look this up once rather than for every jump
+    this->kernel = getKernel().phases[0];
+
+    this->setRate(CLOCK_SPEED, AUDIO_SAMPLE_RATE);
+    this->clear();
+}
+
+void BlipBuffer::setRate(double clockRate, double sampleRate)
+{
+    this->factor = (unsigned long long) (sampleRate / clockRate * 4294967296.0 + 0.5);
+}
+
+void BlipBuffer::clear()
+{
+    this->offset = 0;
+    this->integrator = 0;
+    memset(this->buffer, 0, sizeof(this->buffer));
+}
+
+void BlipBuffer::addDelta(int time, float delta)
+{
+    unsigned long long position = this->offset + (unsigned long long) time * this->factor;
+    unsigned long long sample = position >> 32;
+
+    // The top bits of the fraction pick which phase of the kernel to use
+    int phase = (position >> (32 - BLIP_KERNEL_PHASE_BITS)) & (BLIP_KERNEL_PHASES - 1);
+
+    // The APU flushes often enough for this never to happen, but a jump past
+    // the end of the buffer would write past the end of it
+    if (sample >= BLIP_BUFFER_SAMPLES)
+    {
+        return;
+    }
+
+    addKernel(this->buffer + sample, this->kernel + phase * BLIP_KERNEL_WIDTH, delta);
+}
+
+void BlipBuffer::endFrame(int time)
+{
+    this->offset += (unsigned long long) time * this->factor;
+}
+
+int BlipBuffer::getSamplesAvailable()
+{
+    return (int) (this->offset >> 32);
+}
+
+void BlipBuffer::readSamples(float *out, int count)
+{
+    // Sum the differences back up into samples
+    for (int i = 0; i < count; i++)
+    {
+        this->integrator += this->buffer[i];
+        out[i] = this->integrator;
+    }
+
+    // Move what is left (including the ends of the kernels past the last
+    // finished sample) to the start
+    int remaining = this->getSamplesAvailable() - count + BLIP_KERNEL_WIDTH;
+    memmove(this->buffer, this->buffer + count, remaining * sizeof(float));
+    memset(this->buffer + remaining, 0, count * sizeof(float));
+
+    this->offset -= (unsigned long long) count << 32;
+}
+
+void BlipBuffer::saveState(StateWriter &state)
+{
+    state.put(this->offset);
+    state.putFloat(this->integrator);
+    for (int i = 0; i < BLIP_BUFFER_SAMPLES + BLIP_KERNEL_WIDTH; i++)
+    {
+        state.putFloat(this->buffer[i]);
+    }
+}
+
+void BlipBuffer::loadState(StateReader &state)
+{
+    state.get(this->offset);
+    state.getFloat(this->integrator);
+    for (int i = 0; i < BLIP_BUFFER_SAMPLES + BLIP_KERNEL_WIDTH; i++)
+    {
+        state.getFloat(this->buffer[i]);
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ *
+ * BAND-LIMITED SYNTHESIS BUFFER
+ * The APU's channels are square waves - their output only ever jumps from one
+ * level to another. Rather than working out the output on every cycle (4 MHz)
+ * and filtering it down to the sample rate, the APU tells this buffer when
+ * and by how much the output jumps, and it adds a band-limited step at that
+ * time straight into the output samples. Anything the sample rate can't
+ * carry is filtered out of the step, so there is no aliasing, and the work
+ * done is per jump rather than per cycle.
+ *
+ * The buffer holds the differences between samples. Each jump adds the
+ * impulse response of a low pass filter (a windowed sinc, BLIP_KERNEL_WIDTH
+ * samples wide), and reading the samples sums the differences back up. The
+ * impulse is picked from BLIP_KERNEL_PHASES versions, each shifted by a fraction
+ * of a sample, so a jump lands between samples where it should (a polyphase
+ * filter). Adding the impulse is the inner loop, and is 4 SSE2 multiplies
+ * and adds wherever SSE2 is there at compile time (always on x86-64)
+ *
+ * Times are in cycles since the end of the last frame (see endFrame). Only
+ * samples that no jump from now on can change can be read
+ *
+ **/
+
+#ifndef __BLIPBUFFER_H_INCLUDED__
+#define __BLIPBUFFER_H_INCLUDED__
+
+#include "savestate.h"
+#include "utils.h"
+
+class BlipBuffer {
+
+    public:
+        BlipBuffer();
+
+        // Set how many cycles (clockRate) make how many samples (sampleRate)
+        void setRate(double clockRate, double sampleRate);
+
+        // Throw away anything in the buffer
+        void clear();
+
+        // The output jumps by delta at time (cycles since the last endFrame)
+        void addDelta(int time, float delta);
+
+        // Everything up to time has been added. Times start from here again
+        void endFrame(int time);
+
+        // How many samples are finished and can be read
+        int getSamplesAvailable();
+
+        // Take count finished samples out of the buffer
+        void readSamples(float *out, int count);
+
+        // What is in the buffer and where time 0 is. The rate isn't part of
+        // it - that is set by whoever is playing the samples
+        void saveState(StateWriter &state);
+        void loadState(StateReader &state);
+
+    private:
+        // Where time 0 is, in samples. The top 32 bits are the whole samples
+        // and the bottom 32 bits the fraction
+        unsigned long long offset = 0;
+
+        // Samples per cycle in the same format
+        unsigned long long factor = 0;
+
+        // The phases of the kernel, one after another
+        const float *kernel;
+
+        // The sum of all of the differences read so far
+        float integrator = 0;
+
+        // Differences between each sample and the one before, with room for
+        // the kernel to go past the last sample
+        float buffer[BLIP_BUFFER_SAMPLES + BLIP_KERNEL_WIDTH];
+};
+
+#endif
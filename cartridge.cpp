@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <climits>
+#include <cstring>
+
+#include "cartridge.h"
+#include "utils.h"
+
+using namespace std;
+
+mutex Cartridge::loadedMutex;
+map<string, weak_ptr<const Cartridge>> Cartridge::loaded;
+
+shared_ptr<const Cartridge> Cartridge::load(const char *path)
+{
+    // Use the full path so different ways of naming the
+    // same file still share an image
+    char fullPath[PATH_MAX];
+    if (realpath(path, fullPath) == NULL)
+    {
+        return NULL;
+    }
+
+    lock_guard<mutex> lock(loadedMutex);
+
+    map<string, weak_ptr<const Cartridge>>::iterator found = loaded.find(fullPath);
+    if (found != loaded.end())
+    {
+        shared_ptr<const Cartridge> existing = found->second.lock();
+        if (existing)
+        {
+            return existing;
+        }
+    }
+
+    // Forget images nobody is using any more, so the map only holds
+    // what is loaded rather than every ROM ever asked for
+    for (map<string, weak_ptr<const Cartridge>>::iterator it = loaded.begin(); it != loaded.end();)
+    {
+        if (it->second.expired())
+        {
+            it = loaded.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    FILE *in = fopen(fullPath, "rb");
+    if (in == NULL)
+    {
+        return NULL;
+    }
+
+    fseek(in, 0, SEEK_END);
+    long fileSize = ftell(in);
+    fseek(in, 0, SEEK_SET);
+
+    shared_ptr<Cartridge> cartridge(new Cartridge());
+    cartridge->path = fullPath;
+
+    // The ROM is allocated to the size in its header (32KB << value) rather than
+    // the largest cartridge size, so that we only hold what the game needs. The size
+    // is always a power of two so the bank number can be masked to it
+    vector<Byte> &rom = cartridge->rom;
+    rom.resize(MEMORY_ROM_SIZE, 0);
+    fread(rom.data(), 1, MEMORY_ROM_SIZE, in);
+
+    long romSize = MEMORY_ROM_SIZE;
+    if (rom[ROM_SIZE_ADDR] <= 8)
+    {
+        romSize = MEMORY_ROM_SIZE << rom[ROM_SIZE_ADDR];
+    }
+
+    while (romSize < fileSize && romSize < CARTRIDGE_SIZE)
+    {
+        romSize <<= 1;
+    }
+
+    rom.resize(romSize, 0);
+    fseek(in, 0, SEEK_SET);
+    fread(rom.data(), 1, romSize, in);
+    fclose(in);
+
+    // Work out where each bank starts once, rather than every time
+    // an instance changes bank
+    for (long bank = 0; bank < romSize / ROM_BANK_SIZE; bank++)
+    {
+        cartridge->banks.push_back(rom.data() + bank * ROM_BANK_SIZE);
+    }
+
+    cartridge->readHeader();
+
+    loaded[fullPath] = cartridge;
+    return cartridge;
+}
+
+void Cartridge::readHeader()
+{
+    // Once we load the ROM, we need to determine the current bank mode
+    // and set the appropriate flag. Memory address 0x147 specifies the current
+    // bank mode. If the value is 0, MBC is 0. If it is 1, 2 or 3 it is MBC1,
+    // 5 or 6 specifies MBC2 and 0x0F - 0x13 specifies MBC3
+    switch (this->rom[ROM_BANKING_MODE_ADDR])
+    {
+        case 1: this->mbc = MBC_1; break;
+        case 2: this->mbc = MBC_1; break;
+        case 3: this->mbc = MBC_1; break;
+        case 5: this->mbc = MBC_2; break;
+        case 6: this->mbc = MBC_2; break;
+        case 0x0F: this->mbc = MBC_3; break;
+        case 0x10: this->mbc = MBC_3; break;
+        case 0x11: this->mbc = MBC_3; break;
+        case 0x12: this->mbc = MBC_3; break;
+        case 0x13: this->mbc = MBC_3; break;
+        default: break;
+    }
+
+    // The same address tells us if the cartridge has a battery (so RAM
+    // should be saved) and if it has a real time clock (MBC3 only)
+    switch (this->rom[ROM_BANKING_MODE_ADDR])
+    {
+        case 0x03: this->battery = true; break;
+        case 0x06: this->battery = true; break;
+        case 0x09: this->battery = true; break;
+        case 0x0F: this->battery = true; this->rtc = true; break;
+        case 0x10: this->battery = true; this->rtc = true; break;
+        case 0x13: this->battery = true; break;
+        default: break;
+    }
+}
+
+const Byte *Cartridge::getRom() const
+{
+    return this->rom.data();
+}
+
+int Cartridge::getRomSize() const
+{
+    return this->rom.size();
+}
+
+const Byte *Cartridge::getBank(int bank) const
+{
+    return this->banks[bank & this->getBankMask()];
+}
+
+int Cartridge::getBankMask() const
+{
+    return this->banks.size() - 1;
+}
+
+string Cartridge::getTitle() const
+{
+    // The title is up to 16 characters, padded with zeros
+    const char *title = (const char *) this->rom.data() + TITLE_ADDR;
+    return string(title, strnlen(title, TITLE_LENGTH));
+}
+
+Word Cartridge::getChecksum() const
+{
+    return (this->rom[GLOBAL_CHECKSUM_ADDR] << 8) | this->rom[GLOBAL_CHECKSUM_ADDR + 1];
+}
+
+string Cartridge::getSavePath() const
+{
+    return this->getPathWithExtension(".sav");
+}
+
+string Cartridge::getStatePath() const
+{
+    return this->getPathWithExtension(".state");
+}
+
+string Cartridge::getPathWithExtension(const char *extension) const
+{
+    // The file goes next to the ROM, with the extension changed
+    size_t dot = this->path.find_last_of('.');
+    size_t directory = this->path.find_last_of('/');
+    if (dot == string::npos || (directory != string::npos && dot < directory))
+    {
+        return this->path + extension;
+    }
+
+    return this->path.substr(0, dot) + extension;
+}
+
+MbcType Cartridge::getMbc() const
+{
+    return this->mbc;
+}
+
+bool Cartridge::hasBattery() const
+{
+    return this->battery;
+}
+
+bool Cartridge::hasRtc() const
+{
+    return this->rtc;
+}
+
+int Cartridge::getRamSize() const
+{
+    // MBC2 has 512 half bytes of RAM built in, otherwise the size of
+    // the RAM is in the cartridge header
+    if (this->mbc == MBC_2)
+    {
+        return 512;
+    }
+
+    // We only support up to 4 banks so anything larger is limited to that
+    switch (this->rom[RAM_SIZE_ADDR])
+    {
+        case 0: return 0;
+        case 1: return 0x800;
+        case 2: return RAM_BANK_SIZE;
+        default: return MAXIMUM_RAM_BANKS * RAM_BANK_SIZE;
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ *
+ * CARTRIDGE
+ * This is the immutable image of a cartridge - the ROM data, the information
+ * from its header and a table of where each ROM bank starts. Nothing in here is
+ * ever written to while a game runs, so every instance running the same ROM can
+ * share one image. Loading a ROM that is already loaded hands back the same
+ * image, which is freed when the last instance using it lets it go.
+ *
+ * Anything that changes while running (RAM, bank selection, etc) is per instance
+ * and lives in the Mmu
+ *
+ * HEADER INFO
+ * 0134-0143 Title
+ * 0147      Cartridge Type (MBC and features)
+ * 0148      ROM Size (32KB << value)
+ * 0149      RAM Size
+ * 014E-014F Global checksum (of the whole ROM)
+ *
+ **/
+
+#ifndef __CARTRIDGE_H_INCLUDED__
+#define __CARTRIDGE_H_INCLUDED__
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "utils.h"
+
+enum MbcType {
+    MBC_NONE,
+    MBC_1,
+    MBC_2,
+    MBC_3
+};
+
+class Cartridge {
+
+    public:
+        // Load the ROM at path, or get the image that is already loaded for it.
+        // Returns NULL if the file can't be read
+        static std::shared_ptr<const Cartridge> load(const char *path);
+
+        const Byte *getRom() const;
+        int getRomSize() const;
+
+        // The start of the given ROM bank. The bank number is masked to the
+        // number of banks in the ROM like the hardware does
+        const Byte *getBank(int bank) const;
+        int getBankMask() const;
+
+        std::string getTitle() const;
+        Word getChecksum() const;
+
+        // The battery save (.sav) and save state (.state) go next to the ROM
+        std::string getSavePath() const;
+        std::string getStatePath() const;
+        MbcType getMbc() const;
+        bool hasBattery() const;
+        bool hasRtc() const;
+
+        // Size of the cartridge RAM in bytes, from the header
+        int getRamSize() const;
+
+    private:
+        Cartridge() {};
+
+        std::string path;
+        std::vector<Byte> rom;
+        std::vector<const Byte *> banks;
+
+        MbcType mbc = MBC_NONE;
+        bool battery = false;
+        bool rtc = false;
+
+        void readHeader();
+        std::string getPathWithExtension(const char *extension) const;
+
+        // Images that are currently loaded, by path
+        static std::mutex loadedMutex;
+        static std::map<std::string, std::weak_ptr<const Cartridge>> loaded;
+};
+
+#endif
@@ -0,0 +1,171 @@
+/**
+ *
+ * CORE STATE
+ * This is all of the state that is touched on (nearly) every instruction - the
+ * CPU registers, the interrupt registers, the PPU state and the page table
+ * used by the MMU for reads. Rather than having it spread across the Cpu, Mmu
+ * and Gameboy (each allocated separately), it is packed into one cache
+ * aligned block that they all point at, so an instruction only has to touch
+ * a few cache lines no matter which component is doing the work
+ *
+ **/
+
+#ifndef __CORE_H_INCLUDED__
+#define __CORE_H_INCLUDED__
+
+#include "savestate.h"
+#include "scheduler.h"
+#include "utils.h"
+
+struct alignas(CACHE_LINE_SIZE) Core {
+
+    // Page table for reads. Each entry is where the 4KB page starting at
+    // (index << 12) can be read from directly, or NULL if reads from that page
+    // have side effects and need to go through the MMU. The MMU keeps this up
+    // to date on bank changes
+    const Byte *readPages[16];
+
+    // There are 8 8-bit registers in the Gameboy
+    // A, B, C, D, E, F, H and L. They are usually
+    // referred to in pairs, so we represent them as such
+    Register af;
+    Register bc;
+    Register de;
+    Register hl;
+
+    // The Program Counter is 2 bytes and points to address
+    // in memory of next operation to execute
+    Word programCounter;
+
+    // The Stack Pointer is 2 bytes and points to the top of
+    // the stack in memory. We will use the Register type
+    // because we often need to get hi and lo byte from the
+    // stack
+    Register stackPointer;
+
+    // The master interrupt enabled switch
+    bool interruptMaster = true;
+
+    // Used by instructions DI and EI - we need to know if have a pending
+    // interrupt enable/disable
+    bool willDisableInterrupts = false;
+    bool willEnableInterrupts = false;
+
+    // Specify if the CPU is halted or not
+    bool halted = false;
+
+    // The last opcode executed, for DI and EI
+    Byte lastOpcode = 0;
+
+    // Interrupt enable (0xFFFF) and request (0xFF0F) registers. These are
+    // only changed through the functions below, which keep the interrupts
+    // that are both requested and enabled in interruptPending, so checking
+    // for an interrupt after each instruction is a single test
+    Byte interruptEnable = 0;
+    Byte interruptRequest = 0;
+    Byte interruptPending = 0;
+
+    // The current scanline (0xFF44)
+    Byte currentScanline = 0;
+
+    // Where the PPU is (see ppu.h). The current line started at lineStart
+    // on the clock, and the mode only changes at the boundaries within it.
+    // Mode 3 takes as long as the renderer needs. statLine is the state of
+    // the LCD STAT interrupt line, as an interrupt is only requested when
+    // it goes from low to high
+    unsigned long long lineStart = 0;
+    int transferCycles = 0;
+    Byte lcdMode = 2;
+    bool lcdEnabled = false;
+    bool statLine = false;
+
+    // Total cycles executed
+    unsigned long long clock = 0;
+
+    // Time based events (see scheduler.h)
+    Scheduler scheduler;
+
+    void setInterruptEnable(Byte value)
+    {
+        this->interruptEnable = value;
+        this->interruptPending = this->interruptEnable & this->interruptRequest & INTERRUPT_MASK;
+    }
+
+    void setInterruptRequest(Byte value)
+    {
+        this->interruptRequest = value;
+        this->interruptPending = this->interruptEnable & this->interruptRequest & INTERRUPT_MASK;
+    }
+
+    void requestInterrupt(int bit)
+    {
+        this->setInterruptRequest(this->interruptRequest | (1 << bit));
+    }
+
+    void clearInterrupt(int bit)
+    {
+        this->setInterruptRequest(this->interruptRequest & ~(1 << bit));
+    }
+
+    // Everything but the page table, which the MMU rebuilds
+    void saveState(StateWriter &state)
+    {
+        state.put(this->af.reg);
+        state.put(this->bc.reg);
+        state.put(this->de.reg);
+        state.put(this->hl.reg);
+        state.put(this->programCounter);
+        state.put(this->stackPointer.reg);
+        state.put(this->interruptMaster);
+        state.put(this->willDisableInterrupts);
+        state.put(this->willEnableInterrupts);
+        state.put(this->halted);
+        state.put(this->lastOpcode);
+        state.put(this->interruptEnable);
+        state.put(this->interruptRequest);
+        state.put(this->currentScanline);
+        state.put(this->lineStart);
+        state.put(this->transferCycles);
+        state.put(this->lcdMode);
+        state.put(this->lcdEnabled);
+        state.put(this->statLine);
+        state.put(this->clock);
+        this->scheduler.saveState(state);
+    }
+
+    void loadState(StateReader &state)
+    {
+        Byte enable;
+        Byte request;
+
+        state.get(this->af.reg);
+        state.get(this->bc.reg);
+        state.get(this->de.reg);
+        state.get(this->hl.reg);
+        state.get(this->programCounter);
+        state.get(this->stackPointer.reg);
+        state.get(this->interruptMaster);
+        state.get(this->willDisableInterrupts);
+        state.get(this->willEnableInterrupts);
+        state.get(this->halted);
+        state.get(this->lastOpcode);
+        state.get(enable);
+        state.get(request);
+        state.get(this->currentScanline);
+        state.get(this->lineStart);
+        state.get(this->transferCycles);
+        state.get(this->lcdMode);
+        state.get(this->lcdEnabled);
+        state.get(this->statLine);
+        state.get(this->clock);
+        this->scheduler.loadState(state);
+
+        // This works out interruptPending as well
+        this->setInterruptEnable(enable);
+        this->setInterruptRequest(request);
+    }
+};
+
+static_assert(sizeof(Core) <= CORE_SIZE_BUDGET, "Core is over its memory budget");
+
+#endif
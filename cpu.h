@@ -1,13 +1,14 @@
 #ifndef __CPU_H_INCLUDED__
 #define __CPU_H_INCLUDED__
 
+#include "core.h"
 #include "mmu.h"
 #include "utils.h"
 
 class Cpu {
 
     public:
-        Cpu(Mmu *_mmu) : mmu(_mmu) {};
+        Cpu(Mmu *_mmu, Core *_core) : mmu(_mmu), core(_core) {};
 
         void debug();
 
@@ -29,6 +30,9 @@ class Cpu {
     private:
         Mmu *mmu;
 
+        // The registers and flags live in the core block (see core.h)
+        Core *core;
+
         void pushWordTostack(Word word);
         Word popWordFromStack();
 
@@ -57,36 +61,6 @@ class Cpu {
         void do8BitRegisterShiftRight(Byte *reg, bool maintainMsb=false);
         void doTestBit(Byte value, int bit);
 
-        // There are 8 8-bit registers in the Gameboy
-        // A, B, C, D, E, F, H and L. They are usually
-        // referred to in pairs, so we represent them as such
-        Register af;
-        Register bc;
-        Register de;
-        Register hl;
-
-        // The Program Counter is 2 bytes and points to address
-        // in memory of next operation to execute
-        Word programCounter;
-
-        // The Stack Pointer is 2 bytes and points to the top of
-        // the stack in memory. We will use the Register type
-        // because we often need to get hi and lo byte from the
-        // stack
-        Register stackPointer;
-
-        // The master interrupt enabled switch
-        // This is stored here as the CPU will need direct access to its control
-        bool interruptMaster = true;
-
-        // Used by instructions DI and EI - we need to know if have a pending
-        // interrupt enable/disable
-        bool willDisableInterrupts = false;
-        bool willEnableInterrupts = false;
-
-        // Specify if the CPU is halted or not
-        bool halted = false;
-
 };
 
 #endif
@@ -2,26 +2,54 @@
 #include <stdlib.h>
 #include <SDL2/SDL.h>
 #include <iostream>
+#include <cstring>
 
 #include "display.h"
 #include "mmu.h"
 #include "utils.h"
 
+static_assert(sizeof(Display) <= DISPLAY_SIZE_BUDGET, "Display is over its memory budget");
+
 Color Display::getPixel(int x, int y)
 {
-    return this->screen[x][y];
+    return this->outputPalette[this->screen[y][x]];
+}
+
+Byte *Display::getScreenLine(int line)
+{
+    return this->screen[line];
+}
+
+const Byte *Display::getPaletteShades(int palette)
+{
+    return this->paletteShades[palette];
+}
+
+void Display::setOutputPalette(const Color *colors)
+{
+    memcpy(this->outputPalette, colors, sizeof(this->outputPalette));
+}
+
+void Display::paletteChanged(Word address, Byte data)
+{
+    // Get the appropriate color bits from the palette.
+    // The data maps to the bits in the palette as follows:
+    //  11 - Bits 7 and 6
+    //  10 - Bits 5 and 4
+    //  01 - Bits 3 and 2
+    //  00 - Bits 1 and 0
+    Byte *shades = this->paletteShades[address - BACKGROUND_COLOR_PALETTE_ADDR];
+    for (int colorData = 0; colorData < 4; colorData++)
+    {
+        shades[colorData] = (data >> (colorData * 2)) & 0x3;
+    }
 }
 
 void Display::setPixel(int x, int y)
 {
     // THis is just used to debug the screen a bit - set data into the screen data
     // so we can test it
-    Color color;
-    color.red = 0;
-    color.green = 0;
-    color.blue = 0;
-
-    this->screen[x][y] = color;
+    this->screen[y][x] = 3;
 }
 
 void Display::debug()
@@ -30,405 +58,575 @@ void Display::debug()
     {
         for (int x = 0; x < SCREEN_WIDTH; x++)
         {
-            std::cout << this->screen[x][y].red << " ";
+            std::cout << (int) this->screen[y][x] << " ";
         }
 
         std::cout << std::endl;
     }
 }
 
-void Display::drawScanline()
+Display::~Display()
 {
-    // Get the value of the LCD control register
-    Byte lcdControl = this->mmu->readMemory(LCD_CONTROL_ADDR);
+    this->stopRenderThreads();
+}
 
-    if (isBitSet(lcdControl, 0))
+void Display::latchScanline(int line)
+{
+    if (line >= SCREEN_HEIGHT)
     {
-        // If Bit 0 is set, that means the background is enabled,
-        // and we should draw it
-        this->renderBackground(lcdControl);
+        return;
     }
 
-    if (isBitSet(lcdControl, 1))
+    // A line that is already waiting is from the last frame. That should
+    // have been drawn at V-Blank, but the LCD can be turned off and on
+    // part way through a frame
+    for (int i = 0; i < this->pendingCount; i++)
     {
-        // If Bit 1 is set, that means the sprites are enabled,
-        // and we should draw them
-        this->renderSprites(lcdControl);
+        if (this->pendingLines[i] == line)
+        {
+            this->flush();
+            break;
+        }
+    }
+
+    LineState &state = this->lineStates[line];
+    state.lcdControl = this->mmu->getVideoRegister(LCD_CONTROL_ADDR);
+    state.scrollX = this->mmu->getVideoRegister(SCROLL_X_ADDR);
+    state.scrollY = this->mmu->getVideoRegister(SCROLL_Y_ADDR);
+    state.windowX = this->mmu->getVideoRegister(WINDOW_X_ADDR);
+    state.windowY = this->mmu->getVideoRegister(WINDOW_Y_ADDR);
+    memcpy(state.paletteShades, this->paletteShades, sizeof(state.paletteShades));
+
+    // The sprite lists are shared by every line, so they can only be rebuilt
+    // (if OAM or the sprite size changed) once the lines using them are drawn
+    bool isTallSprite = isBitSet(state.lcdControl, 2);
+    if (isBitSet(state.lcdControl, 1) && (this->spritesDirty || this->spritesTall != isTallSprite))
+    {
+        this->flush();
+        this->buildSpriteLists(isTallSprite);
     }
+
+    this->pendingLines[this->pendingCount++] = line;
 }
 
-void Display::reset()
+void Display::videoMemoryWillChange(Word address)
 {
-    for (int x = 0; x < SCREEN_WIDTH; x++)
+    // Lines waiting to be drawn need to see VRAM and OAM as they
+    // were when they were latched
+    if (this->pendingCount > 0)
     {
-        for (int y = 0; y < SCREEN_HEIGHT; y++)
-        {
-            Color color;
-            color.red = 255;
-            color.green = 255;
-            color.blue = 255;
+        this->flush();
+    }
 
-            this->screen[x][y] = color;
-        }
+    if (this->backgroundCache)
+    {
+        this->backgroundCache->videoMemoryWritten(address);
     }
 }
 
-void Display::renderBackground(Byte lcdControl)
+void Display::videoMemoryReset()
 {
-    Word tileData = 0;
-    Word backgroundMemory = 0;
-    bool isUnsigned = true;
+    this->pendingCount = 0;
+
+    if (this->backgroundCache)
+    {
+        this->backgroundCache->invalidate();
+    }
+}
 
-    Byte currentScanline = this->mmu->readMemory(CURRENT_SCANLINE_ADDR);
+void Display::setBackgroundCache(bool enabled, bool validate)
+{
+    this->flush();
 
-    // if (currentScanline > 1)
-    // {
-    //     printf("0x%.2x\n", currentScanline);
-    // }
+    if (enabled)
+    {
+        // Start with a cache where everything is dirty
+        this->backgroundCache.reset(new BackgroundCache());
+    }
+    else
+    {
+        this->backgroundCache.reset();
+    }
 
-    // We need to figure out where to draw the visual area of the
-    // background as well as the Window
-    Byte scrollX = this->mmu->readMemory(SCROLL_X_ADDR);
-    Byte scrollY = this->mmu->readMemory(SCROLL_Y_ADDR);
-    Byte windowX = this->mmu->readMemory(WINDOW_X_ADDR) - 7;
-    Byte windowY = this->mmu->readMemory(WINDOW_Y_ADDR);
+    this->validateBackgroundCache = validate;
+}
 
-    printf("");
+int Display::getBackgroundMismatches()
+{
+    return this->backgroundMismatches;
+}
 
-    // We need to determine if the current scanline we are drawing
-    // is part of the window as opposed to the background
-    // The window sits above the background, but below any sprites
-    bool usingWindow = false;
-    if (isBitSet(lcdControl, 5))
+void Display::flush()
+{
+    if (this->pendingCount == 0)
+    {
+        return;
+    }
+
+    // The cache is brought up to date before drawing (so the lines can be drawn
+    // on any thread) with the tile numbering of the first line that needs it.
+    // Any line that uses the other numbering is drawn without the cache
+    if (this->backgroundCache)
     {
-        // Bit 5 of lcdControl determines whether or not the window
-        // is enabled
-        if (windowY <= currentScanline)
+        for (int i = 0; i < this->pendingCount; i++)
         {
-            // If the window is within the range of the current scanline
-            usingWindow = true;
+            Byte lcdControl = this->lineStates[this->pendingLines[i]].lcdControl;
+            if (isBitSet(lcdControl, 0))
+            {
+                this->backgroundCache->update(this->mmu->getVideoRam(), this->mmu->getTileCache(), isBitSet(lcdControl, 4));
+                break;
+            }
         }
     }
 
-    // Let's determine which tile data we are using
-    // Bit 4 of LCD control will tell us where this is
-    // If it is 0, we will look in region starting at 0x8800
-    // If it is 1, we will look in region starting at 0x8000
-    if (isBitSet(lcdControl, 4))
+    if (this->workers.empty())
     {
-        tileData = 0x8000;
+        for (int i = 0; i < this->pendingCount; i++)
+        {
+            this->renderLine(this->pendingLines[i]);
+        }
     }
     else
     {
-        tileData = 0x8800;
+        // Lines don't depend on each other, so the workers (and this thread)
+        // just take the next line that hasn't been taken until they are all done
+        {
+            std::lock_guard<std::mutex> lock(this->workMutex);
+            this->nextPendingLine = 0;
+            this->linesDone = 0;
+            this->workOpen = true;
+            this->workGeneration++;
+        }
+
+        this->workReady.notify_all();
+        this->renderPendingLines();
 
-        // We are using a signed byte for the tile identifier number
-        // if we are in this region
-        isUnsigned = false;
+        // Wait for the other lines, and for any worker that woke up to have
+        // finished looking, before anything (i.e. pendingCount) changes
+        std::unique_lock<std::mutex> lock(this->workMutex);
+        this->workDone.wait(lock, [this] { return this->linesDone == this->pendingCount && this->activeWorkers == 0; });
+        this->workOpen = false;
     }
 
-    // The tile identifier number is in one of two regions. Based on if we
-    // are drawing the window or not, we should test but 6 (for window) or
-    // 3 (for background) to determine which region we will look in
-    if (usingWindow)
+    this->pendingCount = 0;
+}
+
+void Display::finishFrame()
+{
+    // Whether lines are drawn is only decided here, once the whole frame is
+    // known to belong to a frame that won't be shown. Lines flushed before
+    // this (for a VRAM write, say) are always drawn, as with run ahead the
+    // frame they are part of can end in a frame that is shown
+    if (!this->drawing)
     {
-        if (isBitSet(lcdControl, 6))
-        {
-            backgroundMemory = 0x9C00;
-        }
-        else
-        {
-            backgroundMemory = 0x9800;
-        }
+        this->pendingCount = 0;
+        return;
     }
-    else
+
+    this->flush();
+}
+
+void Display::setRenderThreads(int count)
+{
+    this->flush();
+    this->stopRenderThreads();
+
+    this->stopWorkers = false;
+    for (int i = 0; i < count; i++)
     {
-        if (isBitSet(lcdControl, 3))
+        this->workers.push_back(std::thread(&Display::doRenderWork, this));
+    }
+}
+
+void Display::stopRenderThreads()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->workMutex);
+        this->stopWorkers = true;
+    }
+
+    this->workReady.notify_all();
+    for (std::thread &worker : this->workers)
+    {
+        worker.join();
+    }
+
+    this->workers.clear();
+}
+
+void Display::doRenderWork()
+{
+    int generation = 0;
+
+    std::unique_lock<std::mutex> lock(this->workMutex);
+    while (true)
+    {
+        this->workReady.wait(lock, [this, generation] { return this->stopWorkers || (this->workOpen && this->workGeneration != generation); });
+        if (this->stopWorkers)
         {
-            backgroundMemory = 0x9C00;
+            return;
         }
-        else
+
+        generation = this->workGeneration;
+        this->activeWorkers++;
+
+        lock.unlock();
+        this->renderPendingLines();
+        lock.lock();
+
+        this->activeWorkers--;
+        if (this->linesDone == this->pendingCount && this->activeWorkers == 0)
         {
-            backgroundMemory = 0x9800;
+            this->workDone.notify_one();
         }
     }
+}
 
-    // Each tile is 8x8 pixels. Each line of the tile (i.e. 8 pixels)
-    // needs two bytes of data in memory to determine the proper color
-    // There are 32 vertical tiles (each 8x8) that fill up the whole
-    // possible range of 256 pixel height of the screen. Using data
-    // above, we can determine WHICH tile we are drawing
+void Display::renderPendingLines()
+{
+    int done = 0;
+    int i;
+    while ((i = this->nextPendingLine++) < this->pendingCount)
+    {
+        this->renderLine(this->pendingLines[i]);
+        done++;
+    }
 
-    Byte yPos = 0;
-    if (usingWindow)
+    if (done > 0)
     {
-        yPos = currentScanline - windowY;
+        std::lock_guard<std::mutex> lock(this->workMutex);
+        this->linesDone += done;
+    }
+}
+
+void Display::renderLine(int line)
+{
+    const LineState &state = this->lineStates[line];
+
+    // The color indices of the background, before the palette. Sprites
+    // behind the background only show through color 0, whatever shade
+    // that is. With no background it is all color 0
+    Byte backgroundColors[SCREEN_WIDTH];
+
+    if (isBitSet(state.lcdControl, 0))
+    {
+        // If Bit 0 is set, that means the background is enabled,
+        // and we should draw it
+        this->renderBackground(line, state, backgroundColors);
     }
     else
     {
-        yPos = scrollY + currentScanline;
+        memset(backgroundColors, 0, sizeof(backgroundColors));
+    }
+
+    if (isBitSet(state.lcdControl, 1))
+    {
+        // If Bit 1 is set, that means the sprites are enabled,
+        // and we should draw them
+        this->renderSprites(line, state, backgroundColors);
     }
+}
 
-    Word tileRow = ((Byte) (yPos / 8)) * 32;
+void Display::setDrawing(bool drawing)
+{
+    this->drawing = drawing;
+}
+
+void Display::saveState(StateWriter &state)
+{
+    state.write(this->screen, sizeof(this->screen));
+}
+
+void Display::loadState(StateReader &state)
+{
+    state.read(this->screen, sizeof(this->screen));
+}
 
-    // Each scanline draws 160 pixels horizontally, so we need to draw
-    // them each. Remember, each tile is 8 pixels wide so we should
-    // basically draw 20 tiles for each scanline
-    for (int i = 0; i < SCREEN_WIDTH; i++)
+void Display::reset()
+{
+    // Start with a white screen
+    memset(this->screen, 0, sizeof(this->screen));
+    this->pendingCount = 0;
+}
+
+void Display::renderBackground(int currentScanline, const LineState &state, Byte *colors)
+{
+    // We need to figure out where to draw the visual area of the
+    // background as well as the Window. These were latched for the line
+    Byte lcdControl = state.lcdControl;
+    Byte scrollX = state.scrollX;
+    Byte scrollY = state.scrollY;
+    int windowX = state.windowX - 7;
+    Byte windowY = state.windowY;
+
+    // Let's determine which tile data we are using
+    // Bit 4 of LCD control will tell us where this is
+    // If it is 0, we will look in region starting at 0x8800 and
+    // use a signed byte for the tile identifier number
+    // If it is 1, we will look in region starting at 0x8000
+    bool isUnsigned = isBitSet(lcdControl, 4);
+
+    // The tile identifier numbers for the background and the window
+    // are in one of two regions, based on bits 3 and 6
+    Word backgroundMemory = isBitSet(lcdControl, 3) ? 0x9C00 : 0x9800;
+    Word windowMemory = isBitSet(lcdControl, 6) ? 0x9C00 : 0x9800;
+
+    // We need to determine if the current scanline we are drawing
+    // is part of the window as opposed to the background
+    // The window sits above the background, but below any sprites. If
+    // it is enabled (bit 5) and covers this line, it covers everything
+    // from WX - 7 to the right edge of the screen
+    int windowStart = SCREEN_WIDTH;
+    if (isBitSet(lcdControl, 5) && windowY <= currentScanline && windowX < SCREEN_WIDTH)
     {
-        // We need to get the appropriate xPos to draw the tile at
-        // based on values above
-        Byte xPos = i + scrollX;
+        windowStart = windowX < 0 ? 0 : windowX;
+    }
+
+    // The background is drawn up to where the window starts, and the
+    // window from there. The window is drawn from its own top left corner
+    // so it is offset by where it starts
+    if (this->backgroundCache && this->backgroundCache->isUnsigned() == isUnsigned)
+    {
+        this->renderCachedSpan(colors, 0, windowStart, backgroundMemory, scrollX, scrollY + currentScanline);
+        this->renderCachedSpan(colors, windowStart, SCREEN_WIDTH, windowMemory, -windowStart, currentScanline - windowY);
 
-        // If we are using the window and the pixel is within
-        // the range of the window
-        if (usingWindow)
+        if (this->validateBackgroundCache)
         {
-            if (i >= windowX)
+            Byte direct[SCREEN_WIDTH];
+            this->renderTileSpan(direct, 0, windowStart, backgroundMemory, scrollX, scrollY + currentScanline, isUnsigned);
+            this->renderTileSpan(direct, windowStart, SCREEN_WIDTH, windowMemory, -windowStart, currentScanline - windowY, isUnsigned);
+            if (memcmp(colors, direct, SCREEN_WIDTH) != 0 && this->backgroundMismatches++ == 0)
             {
-                xPos = i - windowX;
+                printf("Background cache doesn't match on line %d\n", currentScanline);
             }
         }
+    }
+    else
+    {
+        this->renderTileSpan(colors, 0, windowStart, backgroundMemory, scrollX, scrollY + currentScanline, isUnsigned);
+        this->renderTileSpan(colors, windowStart, SCREEN_WIDTH, windowMemory, -windowStart, currentScanline - windowY, isUnsigned);
+    }
 
-        // Deterime which horizontal tile we are currently drawing
-        Word tileCol = xPos / 8;
+    // Then the whole line goes through the palette at once
+    this->pixelOps->mapPalette(colors, this->screen[currentScanline], SCREEN_WIDTH, state.paletteShades[0]);
+}
 
-        // We need the tile identification number. It might be signed
-        Word tileAddress = backgroundMemory + tileRow + tileCol;
-        SignedWord tileIdentificationNumber;
-        if (isUnsigned)
-        {
-            tileIdentificationNumber = this->mmu->readMemory(tileAddress);
-        }
-        else
-        {
-            tileIdentificationNumber = (SignedByte) this->mmu->readMemory(tileAddress);
-        }
+void Display::renderTileSpan(Byte *colors, int start, int end, Word mapAddress, Byte xOffset, Byte yPos, bool isUnsigned)
+{
+    // Each tile is 8x8 pixels, and there are 32x32 tiles in the 256x256
+    // map. Using yPos we can determine which row of tiles we are drawing,
+    // and which line of those tiles
+    const Byte *tileMap = this->mmu->getVideoRam() + (mapAddress - VIDEO_RAM_START) + (yPos / 8) * 32;
+    int tileLine = yPos % 8;
+
+    const TileCache *tileCache = this->mmu->getTileCache();
+
+    // Rather than work out the tile for every pixel, we draw a tile at a time
+    // Only the first tile (if we are scrolled part way into it) and the last
+    // tile (if it runs past the end) are partial, so at most 21 tiles are
+    // fetched for a line
+    int pixel = start;
+    while (pixel < end)
+    {
+        // The position in the map wraps around at 256
+        Byte xPos = pixel + xOffset;
+        int tileColumn = xPos % 8;
 
-        // Using the tileIdentificationNumber, we should be able to determine where in memory
-        // the tile should be. If it is signed value, then we need to properly determine the
-        // position using a signed offset
-        Word tileLocation = tileData;
-        if (isUnsigned)
-        {
-            tileLocation += tileIdentificationNumber * 16;
-        }
-        else
+        int count = 8 - tileColumn;
+        if (count > end - pixel)
         {
-            tileLocation += (tileIdentificationNumber + 128) * 16;
+            count = end - pixel;
         }
 
-        // There are 8 pixels in the tile height, so we need to get the appropriate line
-        Byte line = yPos % 8;
-
-        // This is to get the proper address offset from the tile location. Each tile takes
-        // up two bytes in memory so we need to account for this
-        line *= 2;
-
-        // if (tileLocation != 0x8000 && tileLocation != 0x8800 && tileLocation != 0x8200)
-        // {
-        //     printf("0x%.4x\n", tileLocation);
-        // }
-
-        // This is the tile data. Occupying the two bytes in memory
-        Byte data1 = this->mmu->readMemory(tileLocation + line);
-        Byte data2 = this->mmu->readMemory(tileLocation + line + 1);
-
-        // if (tileAddress == 0x9800)
-        // {
-        //     printf("0x%.4x 0x%.4x 0x%.4x\n", tileLocation, tileIdentificationNumber, tileAddress);
-        // }
-
-        // We now have the two bytes that specify the line of the tile
-        // To get the pixels (i.e. the right color) we need to combine them
-        // This works like the following example (note endianness):
-        //
-        // Pixel #:   0  1  2  3  4  5  6  7
-        // data2 bit: 1  0  1  0  1  1  1  0
-        // data1 bit: 0  0  1  1  0  1  0  1
-        //
-        // Pixel 0 colour id: 10
-        // Pixel 1 colour id: 00
-        // Pixel 2 colour id: 11
-        // Pixel 3 colour id: 01
-        // Pixel 4 colour id: 10
-        // Pixel 5 colour id: 11
-        // Pixel 6 colour id: 10
-        // Pixel 7 colour id: 01
-
-        // This is the bit of the data bytes we are looking at
-        int colorBit = ((xPos % 8) - 7) * -1;
-
-        // Now we need to combine the bits of the data bytes as specified above
-        int colorData = getBitVal(data2, colorBit);
-        colorData <<= 1;
-        colorData |= getBitVal(data1, colorBit);
-
-        Color color = getColor(colorData, BACKGROUND_COLOR_PALETTE_ADDR);
-
-        if (currentScanline < 0 || currentScanline >= SCREEN_HEIGHT || i < 0 || i >= SCREEN_WIDTH)
+        // The tile identification number might be signed, in which case the
+        // tile is offset from the middle of the signed region (0x9000)
+        Byte tileIdentificationNumber = tileMap[xPos / 8];
+        int tile = isUnsigned ? tileIdentificationNumber : 256 + (SignedByte) tileIdentificationNumber;
+
+        // The tile cache has the color of each pixel of the tile line
+        memcpy(colors + pixel, tileCache->getLine(tile, tileLine) + tileColumn, count);
+
+        pixel += count;
+    }
+}
+
+void Display::renderCachedSpan(Byte *colors, int start, int end, Word mapAddress, Byte xOffset, Byte yPos)
+{
+    // The line is a copy from the cached map, wrapping around at 256
+    const Byte *row = this->backgroundCache->getRow(mapAddress == 0x9C00 ? 1 : 0, yPos);
+
+    int pixel = start;
+    while (pixel < end)
+    {
+        Byte xPos = pixel + xOffset;
+
+        int count = BACKGROUND_MAP_SIZE - xPos;
+        if (count > end - pixel)
         {
-            // If we are outside the visible screen do not set data in the screen data as it will
-            // error
-            continue;
+            count = end - pixel;
         }
 
-        // Set the proper pixel in the screen data
-        screen[i][currentScanline] = color;
+        memcpy(colors + pixel, row + xPos, count);
+        pixel += count;
     }
+}
 
+void Display::spritesChanged()
+{
+    // OAM can be written a byte at a time, so rather than rebuild the
+    // sprite lists on every write we rebuild them when the next line
+    // with sprites is latched
+    this->spritesDirty = true;
 }
 
-void Display::renderSprites(Byte lcdControl)
+void Display::buildSpriteLists(bool isTallSprite)
 {
-    // Unlike background, tile identifier for sprites is ALWAYS unsigned
-    // and tile data is always in memory 0x8000 - 0x8FFFF. There are 40 tiles
-    // here and we need to look at them all and find where they should be rendered
     // There is a sprite attribute table in memory 0xFE00 - 0xFE9F. Here, we can
     // look at 4 bytes per sprite. These bytes are as follows:
     //  Byte 0: Sprite Y position - 16
     //  Byte 1: Sprite X position - 8
     //  Byte 2: Pattern number (i.e. sprite identifier to look up in memory)
     //  Byte 3: Attributes
+    const Byte *oam = this->mmu->getOam();
+    for (int sprite = 0; sprite < SPRITE_COUNT; sprite++)
+    {
+        const Byte *entry = oam + sprite * 4; // 4 bytes per sprite
+        this->sprites[sprite].y = entry[0] - 16;
+        this->sprites[sprite].x = entry[1] - 8;
+        this->sprites[sprite].tile = entry[2];
+        this->sprites[sprite].attributes = entry[3];
+    }
+
+    // The hardware only draws the first 10 sprites (in OAM order) that
+    // are on each line
+    memset(this->lineSpriteCounts, 0, sizeof(this->lineSpriteCounts));
+
+    int spriteHeight = isTallSprite ? 16 : 8;
+    for (int sprite = 0; sprite < SPRITE_COUNT; sprite++)
+    {
+        int top = this->sprites[sprite].y;
+        for (int line = top < 0 ? 0 : top; line < top + spriteHeight && line < SCREEN_HEIGHT; line++)
+        {
+            if (this->lineSpriteCounts[line] < MAX_SPRITES_PER_LINE)
+            {
+                this->lineSprites[line][this->lineSpriteCounts[line]++] = sprite;
+            }
+        }
+    }
+
+    // When sprites overlap, the one with the smaller X wins, and if they have
+    // the same X the one first in OAM wins. Each list is already in OAM order
+    // so a stable sort by X puts it in priority order
+    for (int line = 0; line < SCREEN_HEIGHT; line++)
+    {
+        Byte *list = this->lineSprites[line];
+        for (int i = 1; i < this->lineSpriteCounts[line]; i++)
+        {
+            Byte sprite = list[i];
+            int j = i;
+            while (j > 0 && this->sprites[list[j - 1]].x > this->sprites[sprite].x)
+            {
+                list[j] = list[j - 1];
+                j--;
+            }
+
+            list[j] = sprite;
+        }
+    }
+
+    this->spritesDirty = false;
+    this->spritesTall = isTallSprite;
+}
+
+void Display::renderSprites(int currentScanline, const LineState &state, const Byte *backgroundColors)
+{
+    // Unlike background, tile identifier for sprites is ALWAYS unsigned
+    // and tile data is always in memory 0x8000 - 0x8FFFF.
     //
-    // The attributes of the sprite (byte 3) breakdown as follows:
+    // The attributes of the sprite breakdown as follows:
     //  Bit 7: Sprite to Background priority - render above or below background
     //  Bit 6: Y Flip
     //  Bit 5: X Flip
     //  Bit 4: Palette Number - More than one color palette for sprites
     //  Bit 3-0: Not used
 
-    // A tall sprite is 8x16, whereas a small sprite is 8x8
-    bool isTallSprite = isBitSet(lcdControl, 2);
+    // A tall sprite is 8x16, whereas a small sprite is 8x8. The sprite
+    // lists were built for this size when the line was latched
+    bool isTallSprite = isBitSet(state.lcdControl, 2);
 
-    // There are 40 sprites, so check them all
-    for (int sprite = 0; sprite < 40; sprite++)
+    int spriteHeight = isTallSprite ? 16 : 8;
+    const TileCache *tileCache = this->mmu->getTileCache();
+    Byte *screenLine = this->screen[currentScanline];
+
+    // Draw the sprites on this line highest priority first. Each pixel
+    // belongs to the first sprite that isn't transparent there, even if
+    // that sprite is behind the background and doesn't show - the sprites
+    // below it are still hidden
+    bool covered[SCREEN_WIDTH] = {};
+    for (int i = 0; i < this->lineSpriteCounts[currentScanline]; i++)
     {
-        int memoryIdx = sprite * 4; // 4 bytes per sprite, so get proper starting point
-        Byte yPosition = this->mmu->readMemory(SPRITE_ATTRIBUTE_TABLE_ADDR + memoryIdx) - 16;
-        Byte xPosition = this->mmu->readMemory(SPRITE_ATTRIBUTE_TABLE_ADDR + memoryIdx + 1) - 8;
-        Byte tileLocation = this->mmu->readMemory(SPRITE_ATTRIBUTE_TABLE_ADDR + memoryIdx + 2);
-        Byte attributes = this->mmu->readMemory(SPRITE_ATTRIBUTE_TABLE_ADDR + memoryIdx + 3);
+        const Sprite &sprite = this->sprites[this->lineSprites[currentScanline][i]];
+
+        int line = currentScanline - sprite.y;
 
-        bool yFlip = isBitSet(attributes, 6);
-        bool xFlip = isBitSet(attributes, 5);
+        // If we have Y flip, read the sprite in backwards to achieve the flip
+        if (isBitSet(sprite.attributes, 6))
+        {
+            line = spriteHeight - 1 - line;
+        }
 
-        int currentScanline = this->mmu->readMemory(CURRENT_SCANLINE_ADDR);
+        // Tall sprites are two tiles, and the hardware ignores the
+        // lowest bit of the tile number for them
+        int tile = isTallSprite ? (sprite.tile & 0xFE) + line / 8 : sprite.tile;
+        const Byte *spriteLine = tileCache->getLine(tile, line % 8);
 
-        // We should only draw this sprite if it intercepts with the scanline that we are currently drawing
-        int spriteHeight = isTallSprite ? 16 : 8;
-        if (currentScanline >= yPosition && currentScanline < yPosition + spriteHeight)
+        // If we have X Flip, read the sprite line in backwards to achieve the flip
+        Byte colors[8];
+        if (isBitSet(sprite.attributes, 5))
+        {
+            this->pixelOps->flipLine(spriteLine, colors);
+        }
+        else
         {
-            int line = currentScanline - yPosition;
+            memcpy(colors, spriteLine, 8);
+        }
+
+        Byte shades[8];
+        this->pixelOps->mapPalette(colors, shades, 8, state.paletteShades[isBitSet(sprite.attributes, 4) ? 2 : 1]);
 
-            // If we have Y flip, read the sprite in backwards to achieve the flip
-            if (yFlip)
+        for (int xPixel = 0; xPixel < 8; xPixel++)
+        {
+            // Color 0 is transparent for sprites, so we shouldn't set the data at all
+            if (colors[xPixel] == 0)
             {
-                line = (line - spriteHeight) * -1;
+                continue;
             }
 
-            // Remember each tile (sprite or background) has two bytes of memory
-            // So do this to get the appropriate address
-            line *= 2;
+            int pixel = sprite.x + xPixel;
+            if (pixel < 0 || pixel >= SCREEN_WIDTH)
+            {
+                // If we are outside the visible screen do not set data in the screen data as it will
+                // error
+                continue;
+            }
 
-            // Get the address to find the sprite data
-            Word dataAddress = 0x8000 + (tileLocation * 16) + line;
+            // A higher priority sprite already has this pixel
+            if (covered[pixel])
+            {
+                continue;
+            }
 
-            // This is the tile data. Occupying the two bytes in memory
-            Byte data1 = this->mmu->readMemory(dataAddress + line);
-            Byte data2 = this->mmu->readMemory(dataAddress + line + 1);
+            covered[pixel] = true;
 
-            // With background we had the pixel as we were looping through every horizontal pixel in
-            // the scanline. Here we need to get the horizontal pixel from the sprite. Check them
-            // right to left to read color data properly (similar to background)
-            for (int tilePixel = 7; tilePixel >= 0; tilePixel--)
+            // Background priority - If pixel should be behind the background, don't draw it
+            // unless the background there is color 0
+            if (isBitSet(sprite.attributes, 7) && backgroundColors[pixel] != 0)
             {
-                int colorBit = tilePixel;
-
-                // If we have X Flip, read the sprite in backwards to achieve the flip
-                if (xFlip)
-                {
-                    colorBit = (colorBit - 7) * -1;
-                }
-
-                // Now we need to combine the bits of the data bytes as specified above
-                int colorData = getBitVal(data2, colorBit);
-                colorData <<= 1;
-                colorData |= getBitVal(data1, colorBit);
-
-                Word paletteAddr = isBitSet(attributes, 4) ? SPRITE_COLOR_PALETTE_2_ADDR : SPRITE_COLOR_PALETTE_1_ADDR;
-                Color color = getColor(colorData, paletteAddr);
-
-                // Sprite don't really have the "WHITE" color - they are transparent here, so we shouldn't set the data
-                // at all
-                if (color.red == 0xFF && color.green == 0XFF && color.blue == 0xFF)
-                {
-                    continue;
-                }
-
-                int xPixel = 0 - tilePixel;
-                xPixel += 7;
-                int pixel = xPosition + xPixel;
-
-                if (currentScanline < 0 || currentScanline >= SCREEN_HEIGHT || pixel < 0 || pixel >= SCREEN_WIDTH)
-                {
-                    // If we are outside the visible screen do not set data in the screen data as it will
-                    // error
-                    continue;
-                }
-
-                // Background priority - If pixel should be behind the background, don't draw it
-                if (isBitSet(attributes, 7))
-                {
-                    if (screen[currentScanline][pixel].red != 255 || screen[currentScanline][pixel].green != 255 || screen[currentScanline][pixel].blue != 255)
-                    {
-                        continue;
-                    }
-                }
-
-
-                // Set the proper pixel in the screen data
-                screen[pixel][currentScanline] = color;
+                continue;
             }
+
+            // Set the proper pixel in the screen data
+            screenLine[pixel] = shades[xPixel];
         }
     }
 }
-
-Color Display::getColor(int colorData, Word paletteAddr)
-{
-    Color color;
-    int colorBits = 0;
-
-    Byte palette = this->mmu->readMemory(paletteAddr);
-
-    // Get the appropriate color bits from the palette.
-    // The data maps to the bits in the palette as follows:
-    //  11 - Bits 7 and 6
-    //  10 - Bits 5 and 4
-    //  01 - Bits 3 and 2
-    //  00 - Bits 1 and 0
-    switch (colorData)
-    {
-        case 3: colorBits = (getBitVal(palette, 7) << 1) | getBitVal(palette, 6); break;
-        case 2: colorBits = (getBitVal(palette, 5) << 1) | getBitVal(palette, 4); break;
-        case 1: colorBits = (getBitVal(palette, 3) << 1) | getBitVal(palette, 2); break;
-        case 0: colorBits = (getBitVal(palette, 1) << 1) | getBitVal(palette, 0); break;
-        default: printf("UH OH\n");
-    }
-
-    // We will have two bits now that map to colors as follows:
-    //  00 = White = 0xFFFFFF
-    //  01 = Light Gray = 0xCCCCCC
-    //  10 = Dark Gray = 0x777777
-    //  11 = Black = 0x000000
-    switch (colorBits)
-    {
-        case 0: color.red = 0xFF; color.green = 0xFF; color.blue = 0xFF; break;
-        case 1: color.red = 0xCC; color.green = 0xCC; color.blue = 0xCC; break;
-        case 2: color.red = 0x77; color.green = 0x77; color.blue = 0x77; break;
-        case 3: color.red = 0x00; color.green = 0x00; color.blue = 0x00; break;
-        default: printf("UH OH\n");
-    }
-
-    return color;
-}
\ No newline at end of file
@@ -1,32 +1,166 @@
 #ifndef __DISPLAY_H_INCLUDED__
 #define __DISPLAY_H_INCLUDED__
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bgcache.h"
 #include "mmu.h"
+#include "pixelops.h"
+#include "savestate.h"
+#include "videoobserver.h"
 #include "utils.h"
 
-class Display {
+// A sprite from OAM, with its position on the screen
+struct Sprite {
+    SignedWord y;
+    SignedWord x;
+    Byte tile;
+    Byte attributes;
+};
+
+// Everything a scanline depends on other than VRAM and OAM, latched when the
+// line starts being drawn (mode 3) so it can be drawn later
+struct LineState {
+    Byte lcdControl;
+    Byte scrollX;
+    Byte scrollY;
+    Byte windowX;
+    Byte windowY;
+    Byte paletteShades[3][4];
+};
+
+// Lines are not drawn as the CPU gets to them. The registers each line
+// depends on are latched (see latchScanline), and the lines are drawn as a
+// batch at V-Blank (see flush), optionally spread across worker threads. VRAM
+// and OAM are not latched - instead the MMU tells us before they are written
+// so the lines waiting to be drawn can be drawn with the old contents first
+class Display : public VideoObserver {
 
     public:
-        Display(Mmu *_mmu) : mmu(_mmu) {};
+        Display(Mmu *_mmu) : mmu(_mmu), pixelOps(getPixelOps()), backgroundMismatches(0)
+        {
+            this->mmu->setVideoObserver(this);
+            this->setOutputPalette(OUTPUT_PALETTE_GREY);
+        };
+        ~Display();
+
+        // Latch the registers for a line that is starting to be drawn
+        void latchScanline(int line);
+
+        // Draw every line that has been latched but not drawn
+        void flush();
+
+        // At V-Blank, draw the rest of the frame (or throw it away when not
+        // drawing)
+        void finishFrame();
+
+        // Draw lines on this many threads (0 draws on the calling thread)
+        void setRenderThreads(int count);
+
+        // When not drawing, frames that end at V-Blank are thrown away rather
+        // than drawn (as they won't be shown)
+        void setDrawing(bool drawing);
+
+        // What is on the screen, so a state shows its picture as soon as it
+        // is loaded. Everything else is derived from the MMU's state
+        void saveState(StateWriter &state);
+        void loadState(StateReader &state);
 
-        void drawScanline();
         void reset();
 
         Color getPixel(int x, int y);
 
+        // For renderers that draw a pixel at a time (see pixelfifo.h), the
+        // shades of a line of the screen and the current shades of BGP, OBP0
+        // and OBP1
+        Byte *getScreenLine(int line);
+        const Byte *getPaletteShades(int palette);
+
+        // The colors the 4 shades are shown as (see OUTPUT_PALETTE_GREY)
+        void setOutputPalette(const Color *colors);
+
+        void paletteChanged(Word address, Byte data);
+        void spritesChanged();
+        void videoMemoryWillChange(Word address);
+        void videoMemoryReset();
+
+        // Draw the background and window from a cached copy of the whole map
+        // (see bgcache.h). When validating, every line is also drawn directly
+        // and any difference is counted
+        void setBackgroundCache(bool enabled, bool validate = false);
+        int getBackgroundMismatches();
+
         void setPixel(int x, int y);
         void debug();
 
     private:
         Mmu *mmu;
 
-        // The screen has width * height (color is RGB)
-        Color screen[SCREEN_WIDTH][SCREEN_HEIGHT];
+        // Decoding and palette operations for this CPU (see pixelops.h)
+        const PixelOps *pixelOps;
+
+        // The screen has width * height. We only store the shade (0 - 3) of each
+        // pixel, which is turned into a color when the frame is presented
+        Byte screen[SCREEN_HEIGHT][SCREEN_WIDTH];
+
+        // The shade of each color (0 - 3) in BGP, OBP0 and OBP1, indexed from
+        // BGP. These are rebuilt when a palette is written rather than decoded
+        // for every pixel
+        Byte paletteShades[3][4] = {};
+
+        Color outputPalette[4];
+
+        // Sprites parsed from OAM, and the sprites on each line (at most 10)
+        // in the order they should be drawn. These are rebuilt when OAM changes
+        Sprite sprites[SPRITE_COUNT];
+        Byte lineSprites[SCREEN_HEIGHT][MAX_SPRITES_PER_LINE];
+        Byte lineSpriteCounts[SCREEN_HEIGHT];
+        bool spritesDirty = true;
+        bool spritesTall = false;
+
+        std::unique_ptr<BackgroundCache> backgroundCache;
+        bool validateBackgroundCache = false;
+        std::atomic<int> backgroundMismatches;
+
+        // Latched lines waiting to be drawn
+        LineState lineStates[SCREEN_HEIGHT];
+        Byte pendingLines[SCREEN_HEIGHT];
+        int pendingCount = 0;
+        bool drawing = true;
+
+        // Worker threads which take pending lines to draw when flushing
+        std::vector<std::thread> workers;
+        std::mutex workMutex;
+        std::condition_variable workReady;
+        std::condition_variable workDone;
+        int workGeneration = 0;
+        bool workOpen = false;
+        int activeWorkers = 0;
+        int linesDone = 0;
+        bool stopWorkers = false;
+        std::atomic<int> nextPendingLine;
+
+        void stopRenderThreads();
+        void doRenderWork();
+        void renderPendingLines();
+
+        void renderLine(int line);
+
+        // Draws the background and window, leaving their color indices in colors
+        void renderBackground(int line, const LineState &state, Byte *colors);
 
-        void renderBackground(Byte lcdControl);
-        void renderSprites(Byte lcdControl);
+        // Fill the colors of pixels start to end of a line from a tile map, a tile at a time
+        void renderTileSpan(Byte *colors, int start, int end, Word mapAddress, Byte xOffset, Byte yPos, bool isUnsigned);
 
-        Color getColor(int colorData, Word paletteAddr);
+        // The same, copied from the background cache
+        void renderCachedSpan(Byte *colors, int start, int end, Word mapAddress, Byte xOffset, Byte yPos);
+        void renderSprites(int line, const LineState &state, const Byte *backgroundColors);
+        void buildSpriteLists(bool isTallSprite);
 
 };
 
@@ -1,15 +1,19 @@
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <SDL2/SDL.h>
 
 #include "gameboy.h"
+#include "wavwriter.h"
 
 using namespace std;
 
 int debugNum = 10;
 int debugCounter = 0;
 
-void Gameboy::run(Byte *cartridge) {
+template <class Renderer>
+void Gameboy<Renderer>::run(shared_ptr<const Cartridge> cartridge, const char *savePath, int runAheadFrames) {
     cout << "Gameboy is running" << endl;
 
     this->mmu->loadRom(cartridge);
@@ -18,17 +22,40 @@ void Gameboy::run(Byte *cartridge) {
     this->cpu->reset();
     this->mmu->reset();
     this->display->reset();
+    this->ppu.reset();
+
+    // Restore any battery backed RAM after the reset as it would clear it
+    this->mmu->loadBatteryData(savePath);
 
     this->createWindow();
+    this->openAudio();
+
+    // While running, the joypad takes input from the window whenever the
+    // game reads it, as well as at the start of each frame
+    this->mmu->getJoypad()->setInputFetcher(fetchInput, this);
 
     float fps = 59.73;
 
     // ~60fps - This is the amount of times the "update" should execute a second
 	float interval = 1000 / fps;
 
-    unsigned int time = SDL_GetTicks();
+    // When the next frame is due. It moves on by exactly one interval each
+    // frame, rather than to whenever the frame actually ran, so the frame
+    // rate doesn't drift down by however late each frame was (the ticks are
+    // whole milliseconds). The audio can only make up a small difference
+    // between the two (see Apu::controlRate)
+    double nextFrame = SDL_GetTicks() + interval;
 
     int totalCycles = 0;
+    int frames = 0;
+
+    // F5 and F8 save and load a state next to the ROM
+    string statePath = cartridge->getStatePath();
+
+    // The state saved before running ahead is kept here, so once it has
+    // grown to fit it isn't allocated again
+    vector<Byte> state;
+    RunAheadStats runAheadStats;
 
     // Call update 60 times a second (i.e. 60fps)
     SDL_Event event;
@@ -36,301 +63,470 @@ void Gameboy::run(Byte *cartridge) {
     {
         unsigned int currentTime = SDL_GetTicks();
 
-        if (SDL_PollEvent(&event) && event.type == SDL_QUIT)
+        // Take everything that has come in, so key presses are in the
+        // joypad's queue before the next frame runs
+        bool quit = false;
+        while (SDL_PollEvent(&event))
+        {
+            if (event.type == SDL_QUIT)
+            {
+                quit = true;
+            }
+            else
+            {
+                this->handleInput(event, statePath.c_str());
+            }
+        }
+
+        if (quit)
             break;
 
-        if (time + interval < currentTime)
+        if (currentTime >= nextFrame)
         {
-            time = currentTime;
+            nextFrame += interval;
+
+            // If we have fallen well behind (i.e. the window was being
+            // dragged), start again from now rather than rushing to catch up
+            if (currentTime > nextFrame + 4 * interval)
+            {
+                nextFrame = currentTime + interval;
+            }
+
             // std::cout << SDL_GetTicks() << std::endl;
-            totalCycles += this->update();
+            totalCycles += this->update(runAheadFrames, state, runAheadStats);
             // cout << "Total Cycles: " << totalCycles << endl;
             // this->cpu->debug();
             cout << "";
+
+            frames++;
+            if (this->showAudioStats && frames % 60 == 0)
+            {
+                this->printAudioStats();
+            }
+
+            if (runAheadFrames > 0 && frames % 60 == 0)
+            {
+                this->printRunAheadStats(runAheadFrames, runAheadStats);
+            }
         }
     }
 
+    this->mmu->getJoypad()->setInputFetcher(NULL, NULL);
+    this->mmu->closeBatteryData();
+
+    if (this->audioDevice != 0)
+    {
+        SDL_CloseAudioDevice(this->audioDevice);
+    }
+
     SDL_DestroyRenderer(this->renderer);
     SDL_DestroyWindow(this->window);
     SDL_Quit();
 }
 
-int Gameboy::update() {
-    // This is the main execution of a "frame"
-    // We are targeting ~60 FPS
-    // The goal here is to run the CPU and
-    // execute as many instructions per frame as we can
-    // Each Instruction takes a certain number of clock cycles and
-    // We have a maximum number of cycles we can execute per frame (see utils.h)
-    // As soon as we have executed as many cycles as we can for the frame, we can
-    // render the screen
+template <class Renderer>
+bool Gameboy<Renderer>::renderAudio(shared_ptr<const Cartridge> cartridge, int frames, const char *wavPath)
+{
+    this->mmu->loadRom(cartridge);
 
-    int instCycles = 0;
-    int cycles = 0;
+    // The same reset as run, but nothing else (battery RAM, the host's
+    // clock or a window) goes in, so the same ROM always makes the same file
+    this->cpu->reset();
+    this->mmu->reset();
+    this->display->reset();
+    this->ppu.reset();
 
-    while (cycles < MAX_CYCLES_PER_FRAME)
+    Apu *apu = this->mmu->getApu();
+    apu->setSampleRate(AUDIO_SAMPLE_RATE);
+
+    WavWriter wav;
+    if (!wav.open(wavPath, AUDIO_SAMPLE_RATE))
     {
-        instCycles = this->cpu->execute();
-        cycles += instCycles;
+        cout << "Unable to create " << wavPath << endl;
+        return false;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // Nothing waits for the frame timer here. A frame is ~740 samples, well
+    // within the APU's buffer, so taking them all out after each frame means
+    // none are ever dropped
+    AudioFrame samples[AUDIO_DEVICE_FRAMES];
+    for (int frame = 0; frame < frames; frame++)
+    {
+        this->runFrame();
+
+        size_t count;
+        while ((count = apu->getOutput()->pop(samples, AUDIO_DEVICE_FRAMES)) > 0)
+        {
+            wav.write(samples, count);
+        }
+    }
+
+    unsigned long long written = wav.getFramesWritten();
+    bool ok = wav.close();
 
-        this->updateTimers(instCycles);
-        this->updateGraphics(instCycles);
-        this->doInterrupts();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double audioSeconds = (double) written / AUDIO_SAMPLE_RATE;
+    cout << "Rendered " << audioSeconds << "s of audio in " << seconds << "s ("
+         << audioSeconds / seconds << "x real time)" << endl;
+
+    if (!ok)
+    {
+        cout << "Unable to write " << wavPath << endl;
     }
 
-    // this->display->debug();
-    this->renderGame();
-    // this->debugRender();
-    return cycles;
+    return ok;
 }
 
-bool Gameboy::isClockEnabled()
+template <class Renderer>
+double Gameboy<Renderer>::benchmark(shared_ptr<const Cartridge> cartridge, int frames)
 {
-    // Bit 2 of the timer controller addr specifies if the timer is enabled
-    // or not
-    return isBitSet(this->mmu->readMemory(TIMER_CONTROLLER_ADDR), 2);
+    this->mmu->loadRom(cartridge);
+
+    // The same reset as renderAudio, so each run of a ROM does the same work
+    this->cpu->reset();
+    this->mmu->reset();
+    this->display->reset();
+    this->ppu.reset();
+
+    Apu *apu = this->mmu->getApu();
+    apu->setSampleRate(AUDIO_SAMPLE_RATE);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // The samples are taken out and thrown away, as the audio device would
+    // take them, so the APU does all the work it does when playing
+    AudioFrame samples[AUDIO_DEVICE_FRAMES];
+    for (int frame = 0; frame < frames; frame++)
+    {
+        this->runFrame();
+        while (apu->getOutput()->pop(samples, AUDIO_DEVICE_FRAMES) > 0)
+        {
+        }
+    }
+
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count() / frames;
 }
 
-int Gameboy::getClockFrequency()
-{
-    // This will get the first two bits of the timer controller address so we can
-    // set the correct frequency
-    Byte clockFrequency = this->mmu->readMemory(TIMER_CONTROLLER_ADDR) & 0x3;
-    int timerCounter = 0;
-
-    // The timer counter should be set to the value of the speed of the clock
-    // divided by the frequency - therefore it will hit zero at the correct
-    // rate
-    switch (clockFrequency)
+template <class Renderer>
+int Gameboy<Renderer>::update(int runAheadFrames, vector<Byte> &state, RunAheadStats &stats) {
+    // Set how fast the APU makes samples this frame from how much the audio
+    // device has left. Only when something is playing the samples is there
+    // a buffer level to keep steady
+    if (this->audioDevice != 0 && this->rateControl)
     {
-        case 0x0: timerCounter = CLOCK_SPEED / 4096   ; break;
-        case 0x1: timerCounter = CLOCK_SPEED / 262144 ; break;
-        case 0x2: timerCounter = CLOCK_SPEED / 65536  ; break;
-        case 0x3: timerCounter = CLOCK_SPEED / 16384  ; break;
+        this->mmu->getApu()->controlRate();
     }
 
-    return timerCounter;
+    // With run-ahead this frame isn't shown, so there is no need to draw it
+    this->display->setDrawing(runAheadFrames == 0);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int cycles = this->runFrame();
+    stats.frameSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (runAheadFrames > 0)
+    {
+        this->runAhead(runAheadFrames, state, stats);
+    }
+
+    // this->display->debug();
+    this->renderGame();
+    // this->debugRender();
+    return cycles;
 }
 
-void Gameboy::updateDividerCounter(int cycles)
+template <class Renderer>
+void Gameboy<Renderer>::runAhead(int frames, vector<Byte> &state, RunAheadStats &stats)
 {
-    // Incrememt the counter by number of cycles
-    this->dividerCounter += cycles;
-    if (this->dividerCounter >= 256)
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    this->saveState(state);
+    chrono::steady_clock::time_point saved = chrono::steady_clock::now();
+
+    // What the frames ahead write to battery backed RAM mustn't reach the
+    // save file, as they never happened
+    this->mmu->setBatteryDataPrivate(true);
+
+    // The frames ahead keep the buttons as they are (anything still in
+    // the joypad's queue is for the frames that are kept) and aren't heard
+    Apu *apu = this->mmu->getApu();
+    Joypad *joypad = this->mmu->getJoypad();
+    apu->setOutputEnabled(false);
+    joypad->setPolling(false);
+
+    // Only the last one is shown, so only it is drawn
+    for (int frame = 0; frame < frames; frame++)
     {
-        // If we go over 255, reset to 0 and then increase the value of the divider register
-        this->dividerCounter = 0;
-        this->mmu->increaseDividerRegister();
+        this->display->setDrawing(frame == frames - 1);
+        this->runFrame();
     }
+
+    chrono::steady_clock::time_point ran = chrono::steady_clock::now();
+
+    // The screen is left as the last frame drew it, to be shown. The save
+    // file still has the RAM the state does, so loading doesn't touch it
+    this->mmu->setBatteryDataPrivate(false);
+    this->loadState(state.data(), state.size());
+    apu->setOutputEnabled(true);
+    joypad->setPolling(true);
+
+    chrono::steady_clock::time_point loaded = chrono::steady_clock::now();
+
+    stats.frames++;
+    stats.saveSeconds += chrono::duration<double>(saved - start).count();
+    stats.aheadSeconds += chrono::duration<double>(ran - saved).count();
+    stats.loadSeconds += chrono::duration<double>(loaded - ran).count();
 }
 
-void Gameboy::updateTimers(int cycles)
+template <class Renderer>
+void Gameboy<Renderer>::saveState(vector<Byte> &state)
 {
-    this->updateDividerCounter(cycles);
+    state.clear();
+    StateWriter writer(state);
+    this->saveState(writer);
+}
 
-    int threshold = this->getClockFrequency();
+template <class Renderer>
+bool Gameboy<Renderer>::loadState(const Byte *data, size_t size)
+{
+    StateReader reader(data, size);
+    this->loadState(reader);
+    return reader.isValid();
+}
 
-    // Before updating timers, we should check if the frequency just changed in
-    // memory. If it did, we can reset the timer
-    if (this->mmu->isTimerFrequencyChanged()) {
-        this->timerCounter = 0;
-        this->mmu->setTimerFrequencyChanged(false);
-    }
+template <class Renderer>
+void Gameboy<Renderer>::saveState(StateWriter &state)
+{
+    this->core->saveState(state);
+    this->mmu->saveState(state);
+    this->ppu.saveState(state);
+}
 
-    // The clock can be disabled so make sure it is enabled before updating anything
-    if (isClockEnabled())
-    {
-        // If enough cycles have passed, we can update the timer
-        // Update based on how many cycles passed
-        // The timer increments when this hits 0 as that is based on the
-        // frequency in which the timer should increment (i.e. 4096hz)
-        this->timerCounter += cycles;
+template <class Renderer>
+void Gameboy<Renderer>::loadState(StateReader &state)
+{
+    this->core->loadState(state);
+    this->mmu->loadState(state);
+    this->ppu.loadState(state);
+}
 
-        if (this->timerCounter >= threshold)
-        {
-            // cout << this->timerCounter << " " << cycles << endl;
-            // We need to reset the counter value so timer can increment again at the
-            // correct frequency
-            this->timerCounter -= threshold;
-            // this->timerCounter = 0;
-
-            // We need to account for overflow - if overflow then we can write the value
-            // that is held in the modulator addr and request Timer Interrupt which is
-            // bit 2 of the interrupt register in memory
-            // Otherwise we can just increment the timer
-            this->mmu->writeMemory(TIMER_ADDR, this->mmu->readMemory(TIMER_ADDR) + 1);
-            // printf("0x%.2x\n", this->mmu->readMemory(TIMER_ADDR));
-            if (this->mmu->readMemory(TIMER_ADDR) == 0) {
-                // printf("0x%.2x\n", this->mmu->readMemory(TIMER_MODULATOR_ADDR));
-                this->mmu->writeMemory(TIMER_ADDR, this->mmu->readMemory(TIMER_MODULATOR_ADDR));
-                this->cpu->requestInterrupt(2);
-            }
-        }
-    }
+template <class Renderer>
+bool Gameboy<Renderer>::saveStateFile(const char *path)
+{
+    vector<Byte> state;
+    this->saveState(state);
+
+    StateWriter writer(state);
+    this->display->saveState(writer);
+
+    return StateFile::write(path, *this->mmu->getCartridge(), Renderer::STATE_ID, state);
 }
 
-void Gameboy::doInterrupts()
+template <class Renderer>
+bool Gameboy<Renderer>::loadStateFile(const char *path)
 {
-    // Check for pending interrupts, and if they are enabled
-    Byte pendingInterrupts = this->mmu->readMemory(INTERRUPT_REQUEST_ADDR);
-    if (pendingInterrupts > 0)
+    // The state is read straight out of the mapped file
+    StateFile file;
+    if (!file.open(path, *this->mmu->getCartridge(), Renderer::STATE_ID))
     {
-        // If we have any interrupts pending, check if they are enabled
-        Byte enabledInterrupts = this->mmu->readMemory(INTERRUPT_ENABLED_REGISTER);
-        // printf("PENDING: 0x%.2x ENABLED: 0x%.2x\n", pendingInterrupts, enabledInterrupts);
-        for (int i = 0; i < 5; i++)
-        {
-            // This loop will ensure we can test every bit that an interrupt can be, in order of priority
-            if (isBitSet(pendingInterrupts, i) && isBitSet(enabledInterrupts, i))
-            {
-                this->cpu->serviceInterrupt(i);
-            }
-        }
+        return false;
     }
-}
 
-void Gameboy::updateGraphics(int cycles)
-{
-    this->setLcdStatus();
+    // What is running now, to go back to if the state turns out to be
+    // damaged part way through loading it
+    vector<Byte> backup;
+    this->saveState(backup);
+    StateWriter writer(backup);
+    this->display->saveState(writer);
 
-    if (this->isLcdEnabled())
+    // States are flat, so one that fits this instance is exactly the size
+    // it would save (i.e. the external RAM is the same size)
+    if (file.getStateSize() != backup.size())
     {
-        // We only update the counter if the LCD is enabled
-        this->scanlineCounter -= cycles;
+        cout << path << " is the wrong size for a state of this cartridge" << endl;
+        return false;
     }
 
-    if (this->scanlineCounter <= 0)
+    StateReader reader(file.getState(), file.getStateSize());
+    this->loadState(reader);
+    this->display->loadState(reader);
+    if (reader.isValid())
     {
-        // If the coutner has coutned down (from 456) then it is time to
-        // draw the next scanline
-        this->mmu->updateCurrentScanline();
-        Byte currentScanline = this->mmu->readMemory(CURRENT_SCANLINE_ADDR);
+        return true;
+    }
+
+    StateReader restore(backup.data(), backup.size());
+    this->loadState(restore);
+    this->display->loadState(restore);
+    return false;
+}
+
+template <class Renderer>
+int Gameboy<Renderer>::runFrame() {
+    // This is the main execution of a "frame"
+    // We are targeting ~60 FPS
+    // The goal here is to run the CPU and
+    // execute as many instructions per frame as we can
+    // Each Instruction takes a certain number of clock cycles and
+    // We have a maximum number of cycles we can execute per frame (see utils.h)
+    // As soon as we have executed as many cycles as we can for the frame, we can
+    // render the screen
+
+    int instCycles = 0;
+    int cycles = 0;
 
-        // We need to reset our coutner for the next scanline
-        this->scanlineCounter = 456;
+    // Take any input that came in since the last frame (a game waiting for
+    // the joypad interrupt may not read P1 until it has had it)
+    this->mmu->getJoypad()->startFrame();
 
-        if (currentScanline == 144)
+    while (cycles < MAX_CYCLES_PER_FRAME)
+    {
+        instCycles = this->cpu->execute();
+        cycles += instCycles;
+
+        this->core->clock += instCycles;
+        if (this->core->clock >= this->core->scheduler.getNextTime())
         {
-            // There are 144 visible scanlines (i.e. scanlines 0 - 143)
-            // If we are moving past that scanline, we are not drawing as
-            // it is an invisible scanline. This is the vertical blank period
-            // and we need an interrupt to handle it (which is bit 0 of the)
-            // the interrupt request register
-            this->cpu->requestInterrupt(0);
+            this->doEvents();
         }
-        else if (currentScanline > MAX_SCANLINES)
+
+        // The core keeps the interrupts that are both requested and enabled,
+        // so nothing pending (by far the most common case) is one test
+        if (this->core->interruptPending != 0)
         {
-            // We have gone past the range of scanlines in this case, meaning we
-            // need to reset back to 0
-            this->mmu->resetCurrentScanline();
+            this->doInterrupts();
         }
-        else
+    }
+
+    // Anything the PPU hasn't drawn yet should be on the screen, and the
+    // APU should have made the samples for the whole frame
+    this->ppu.catchUp();
+    this->mmu->getApu()->update();
+
+    return cycles;
+}
+
+template <class Renderer>
+void Gameboy<Renderer>::doEvents()
+{
+    // Handle every event that has become due, in the order they were due
+    int event;
+    while ((event = this->core->scheduler.popDue(this->core->clock)) != EVENT_COUNT)
+    {
+        switch (event)
         {
-            // We are within an appropriate scanline range (i.e. 0 - 143) which
-            // means we can draw
-            this->display->drawScanline();
+            case EVENT_DMA_END: this->mmu->finishDmaTransfer(); break;
+            case EVENT_PPU: this->ppu.update(); break;
+            case EVENT_TIMER: this->mmu->getTimer()->overflow(); break;
         }
     }
 }
 
-bool Gameboy::isLcdEnabled()
+template <class Renderer>
+void Gameboy<Renderer>::doInterrupts()
 {
-    Byte lcdControl = this->mmu->readMemory(LCD_CONTROL_ADDR);
-    return isBitSet(lcdControl, 7); // Bit 7 specified is LCD is enabled
+    // The lower the bit, the higher the priority. Only that interrupt is
+    // serviced - the others stay requested until it returns (or are serviced
+    // first if it re-enables interrupts)
+    this->cpu->serviceInterrupt(__builtin_ctz(this->core->interruptPending));
 }
 
-void Gameboy::setLcdStatus()
+// The keys for each button (see JoypadButton), or -1 if it isn't one
+static int getButton(SDL_Keycode key)
 {
-    Byte lcdStatus = this->mmu->readMemory(LCD_STATUS_ADDR);
+    switch (key)
+    {
+        case SDLK_RIGHT: return BUTTON_RIGHT;
+        case SDLK_LEFT: return BUTTON_LEFT;
+        case SDLK_UP: return BUTTON_UP;
+        case SDLK_DOWN: return BUTTON_DOWN;
+        case SDLK_x: return BUTTON_A;
+        case SDLK_z: return BUTTON_B;
+        case SDLK_BACKSPACE: case SDLK_RSHIFT: return BUTTON_SELECT;
+        case SDLK_RETURN: return BUTTON_START;
+        default: return -1;
+    }
+}
 
-    if (!isLcdEnabled())
+template <class Renderer>
+void Gameboy<Renderer>::handleInput(const SDL_Event &event, const char *statePath)
+{
+    // Holding a key down repeats the key down event, which isn't a new press
+    if ((event.type != SDL_KEYDOWN && event.type != SDL_KEYUP) || event.key.repeat)
     {
-        // If the LCD is disabled, the LCD Status should be in mode 1 (V-Blank)
-        // and we should ensure we reset the scaline
-        this->scanlineCounter = 456;
-        this->mmu->resetCurrentScanline();
-
-        lcdStatus &= 0b11111100; // Turn off bits 0 and 1
-        setBit(&lcdStatus, 0); // Bit 0 should be set for mode 1
-        this->mmu->writeMemory(LCD_STATUS_ADDR, lcdStatus);
         return;
     }
 
-    Byte currentScanline = this->mmu->readMemory(CURRENT_SCANLINE_ADDR);
-    Byte lcdMode = lcdStatus & 0x3; // Get the first two bits to determine LCD Mode
-    Byte newLcdMode = 0;
-    bool shouldRequestInterrupt = false;
-
-    if (currentScanline >= 144)
+    if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F5)
     {
-        // We are in one of our invisible scanlines, which is Vertical Blank period
-        // so we should set the mode to V-Blank (mode 1)
-        newLcdMode = 1;
-        setBit(&lcdStatus, 0);
-        resetBit(&lcdStatus, 1);
-        shouldRequestInterrupt = isBitSet(lcdStatus, 4); // Bit 4 specifies if V-Blank interrupt is enabled
+        cout << (this->saveStateFile(statePath) ? "Saved state to " : "Unable to save state to ") << statePath << endl;
+        return;
     }
-    else
+
+    if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F8)
     {
-        // If we are drawing a current scanline, we should be cycling through the other LCD modes
-        // The cycle starts for a new scanline in mode 2 (Searching Sprite Atts), then after 80 cycles of
-        // the 456 we are counting, we move to mode 3 (Transferring data to LCD driver). Mode 3 will take
-        // another 172 cycles, and then we move to mode 0 (H-Blank). When the counter has gone below 0,
-        // we will have moved to another scanline and we shuold start back at mode 2
-        if (this->scanlineCounter >= 456 - 80)
-        {
-            // We are in Mode 2 here
-            newLcdMode = 2;
-            resetBit(&lcdStatus, 0);
-            setBit(&lcdStatus, 1);
-            shouldRequestInterrupt = isBitSet(lcdStatus, 5); // Bit 5 specifies if Searchiing interrupt is enabled
-        }
-        else if (this->scanlineCounter < 456 - 80 && this->scanlineCounter >= 456 - 80 - 172)
+        if (this->loadStateFile(statePath))
         {
-            // We are in mode 3 here
-            newLcdMode = 3;
-            setBit(&lcdStatus, 1);
-            setBit(&lcdStatus, 1);
+            cout << "Loaded state from " << statePath << endl;
         }
         else
         {
-            // We are in mode 0 here
-            newLcdMode = 0;
-            resetBit(&lcdStatus, 0);
-            resetBit(&lcdStatus, 1);
-            shouldRequestInterrupt = isBitSet(lcdStatus, 3); // Bit 4 specifies if H-Blank interrupt is enabled
+            // Nothing has changed, the game carries on as it was
+            cout << "Unable to load state from " << statePath << endl;
         }
+
+        return;
     }
 
-    // If we are switching modes and we should request an interrupt, do it
-    if (newLcdMode != lcdMode && shouldRequestInterrupt)
+    this->queueButton(event);
+}
+
+template <class Renderer>
+bool Gameboy<Renderer>::queueButton(const SDL_Event &event)
+{
+    int button = getButton(event.key.keysym.sym);
+    if (button < 0)
     {
-        // Interrupt bit 1 is for LCD interrupt
-        this->cpu->requestInterrupt(1);
+        return false;
     }
 
-    // If the current scanline is the same as the value in 0xFF45, then
-    // we should set the coincidence flag. And appropriately request an
-    // LCD interrupt IF it is enabled (bit 6)
-    if (currentScanline == this->mmu->readMemory(0xFF45))
+    // Repeats are still taken from SDL's queue, but don't change anything
+    if (!event.key.repeat)
     {
-        // Set coincidence flag
-        setBit(&lcdStatus, 2);
-        if (isBitSet(lcdStatus, 6))
-        {
-            this->cpu->requestInterrupt(1);
-        }
+        InputEvent input;
+        input.button = button;
+        input.pressed = event.type == SDL_KEYDOWN;
+        this->mmu->getJoypad()->pushEvent(input);
     }
-    else
+
+    return true;
+}
+
+template <class Renderer>
+void Gameboy<Renderer>::fetchInput(void *userdata)
+{
+    Gameboy<Renderer> *gameboy = (Gameboy<Renderer> *) userdata;
+
+    // Only key events are taken, so quitting (and so on) waits for the
+    // event loop
+    SDL_PumpEvents();
+    SDL_Event events[JOYPAD_QUEUE_EVENTS];
+    int count = SDL_PeepEvents(events, JOYPAD_QUEUE_EVENTS, SDL_GETEVENT, SDL_KEYDOWN, SDL_KEYUP);
+
+    for (int i = 0; i < count; i++)
     {
-        resetBit(&lcdStatus, 2);
+        // This is part way through an instruction, so keys that aren't
+        // buttons (i.e. F5 to save the state) go back for the event loop
+        if (!gameboy->queueButton(events[i]))
+        {
+            SDL_PushEvent(&events[i]);
+        }
     }
-
-    // Finally, update the status now in memory
-    this->mmu->writeMemory(LCD_STATUS_ADDR, lcdStatus);
 }
 
-bool Gameboy::createWindow()
+template <class Renderer>
+bool Gameboy<Renderer>::createWindow()
 {
     if(SDL_Init(SDL_INIT_EVERYTHING) < 0)
 	{
@@ -351,7 +547,90 @@ bool Gameboy::createWindow()
     return true;
 }
 
-void Gameboy::renderGame()
+template <class Renderer>
+bool Gameboy<Renderer>::openAudio()
+{
+    // The callback takes samples straight out of the APU's ring buffer, so
+    // the emulator never has to wait for (or lock against) the audio thread
+    SDL_AudioSpec want;
+    SDL_AudioSpec have;
+    memset(&want, 0, sizeof(want));
+    want.freq = AUDIO_SAMPLE_RATE;
+    want.format = AUDIO_S16SYS;
+    want.channels = 2;
+    want.samples = AUDIO_DEVICE_FRAMES;
+    want.callback = Gameboy<Renderer>::audioCallback;
+    want.userdata = this->mmu->getApu();
+
+    // Devices often run at 48 kHz rather than 44.1 kHz. The APU can make
+    // samples at any rate, so it is better to let it than to have SDL
+    // convert them
+    this->audioDevice = SDL_OpenAudioDevice(NULL, 0, &want, &have, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if (this->audioDevice == 0)
+    {
+        cout << "Unable to open audio: " << SDL_GetError() << endl;
+        return false;
+    }
+
+    this->mmu->getApu()->setSampleRate(have.freq);
+
+    SDL_PauseAudioDevice(this->audioDevice, 0);
+    return true;
+}
+
+template <class Renderer>
+void Gameboy<Renderer>::audioCallback(void *userdata, Uint8 *stream, int length)
+{
+    Apu *apu = (Apu *) userdata;
+    apu->readOutput((AudioFrame *) stream, length / sizeof(AudioFrame));
+}
+
+template <class Renderer>
+void Gameboy<Renderer>::setShowAudioStats(bool show)
+{
+    this->showAudioStats = show;
+}
+
+template <class Renderer>
+void Gameboy<Renderer>::setRateControl(bool enabled)
+{
+    this->rateControl = enabled;
+}
+
+template <class Renderer>
+void Gameboy<Renderer>::printRunAheadStats(int frames, RunAheadStats &stats)
+{
+    if (stats.frames == 0)
+    {
+        return;
+    }
+
+    // The extra cost is everything but running the frames that are kept
+    // (which aren't drawn - the last frame ahead is)
+    double frameMs = stats.frameSeconds * 1000 / stats.frames;
+    double aheadMs = stats.aheadSeconds * 1000 / stats.frames;
+    double saveUs = stats.saveSeconds * 1000000 / stats.frames;
+    double loadUs = stats.loadSeconds * 1000000 / stats.frames;
+    double extraMs = aheadMs + (saveUs + loadUs) / 1000;
+
+    cout << "Run-ahead " << frames << ": " << frameMs + extraMs << "ms a frame, " << extraMs << "ms of it extra"
+         << " (ahead " << aheadMs << "ms, save " << saveUs << "us, load " << loadUs << "us)" << endl;
+
+    stats = RunAheadStats();
+}
+
+template <class Renderer>
+void Gameboy<Renderer>::printAudioStats()
+{
+    AudioStats stats = this->mmu->getApu()->takeAudioStats();
+    cout << "Audio buffer " << stats.minimumFill << "-" << stats.maximumFill
+         << " (average " << stats.averageFill << ") latency " << stats.latencyMs << "ms"
+         << " rate " << stats.rateAdjustment
+         << " underruns " << stats.underrunFrames << " dropped " << stats.droppedFrames << endl;
+}
+
+template <class Renderer>
+void Gameboy<Renderer>::renderGame()
 {
     Color pixel;
 
@@ -371,7 +650,8 @@ void Gameboy::renderGame()
     SDL_RenderPresent(this->renderer);
 }
 
-void Gameboy::debugRender()
+template <class Renderer>
+void Gameboy<Renderer>::debugRender()
 {
     // This is a debug render to dump every tile out to the screen
     if (this->debug)
@@ -380,6 +660,8 @@ void Gameboy::debugRender()
         int screen_x = 0;
         int screen_y = 0;
 
+        // Straight from VRAM, which the CPU's reads can't see during DMA
+        const Byte *videoRam = this->mmu->getVideoRam();
         for (int i = (0x8000); i < (0x8800); i += 2)
         {
 
@@ -395,7 +677,7 @@ void Gameboy::debugRender()
 
             for (int j = 0; j < 8; j++)
             {
-                int p = (((this->mmu->readMemory(i + 1) >> (7 - j)) & 1) << 1 ) | ((this->mmu->readMemory(i) >> (7 - j)) & 1);
+                int p = (((videoRam[i + 1 - VIDEO_RAM_START] >> (7 - j)) & 1) << 1 ) | ((videoRam[i - VIDEO_RAM_START] >> (7 - j)) & 1);
                 // cout << (p > 0 ? "xx" : "  ");
                 if (p > 0)
                 {
@@ -423,9 +705,16 @@ void Gameboy::debugRender()
         }
 
         Word address = 0x9800;
-        Byte b = this->mmu->readMemory(address);
+        Byte b = videoRam[address - VIDEO_RAM_START];
         printf("TEST 0x%.2x\n", b);
 
         SDL_RenderPresent(this->renderer);
     }
-}
\ No newline at end of file
+}
+
+// The renderers the Gameboy can be built with
+template class Gameboy<ScanlineRenderer>;
+template class Gameboy<PixelFifoRenderer>;
+
+static_assert(sizeof(Gameboy<ScanlineRenderer>) <= GAMEBOY_SIZE_BUDGET, "Gameboy is over its memory budget");
+static_assert(sizeof(Gameboy<PixelFifoRenderer>) <= GAMEBOY_SIZE_BUDGET, "Gameboy is over its memory budget");
@@ -1,50 +1,137 @@
 #ifndef __GAMEBOY_H_INCLUDED__
 #define __GAMEBOY_H_INCLUDED__
 
+#include <memory>
+#include <vector>
 #include <SDL2/SDL.h>
 
+#include "cartridge.h"
+#include "core.h"
 #include "cpu.h"
 #include "display.h"
 #include "mmu.h"
+#include "pixelfifo.h"
+#include "ppu.h"
+#include "savestate.h"
+#include "scanline.h"
 #include "utils.h"
 
+// What run-ahead has cost (see Gameboy::run) since it was last printed
+struct RunAheadStats {
+    int frames = 0;
+
+    // Running the frames that are kept, and the frames run ahead of them
+    double frameSeconds = 0;
+    double aheadSeconds = 0;
+
+    // Saving and loading the state around the frames run ahead
+    double saveSeconds = 0;
+    double loadSeconds = 0;
+};
+
+// The Gameboy is built for a PPU renderer (see ppu.h) - ScanlineRenderer
+// for speed or PixelFifoRenderer for accuracy
+template <class Renderer>
 class Gameboy {
 
     public:
-        Gameboy(Mmu *_mmu, Cpu *_cpu, Display *_display) : mmu(_mmu), cpu(_cpu), display(_display) {};
-
-        void run(Byte *cartridge);
+        Gameboy(Core *_core, Mmu *_mmu, Cpu *_cpu, Display *_display) : core(_core), mmu(_mmu), cpu(_cpu), display(_display), ppu(_core, _mmu, _cpu, _display) {};
+
+        // If a save path is given, battery backed RAM is kept in it
+        // while running and flushed to it on exit.
+        //
+        // With run-ahead, each frame is run as usual (but not shown), then
+        // the state is saved, runAheadFrames more frames are run with the
+        // same input, the last one is shown and the state is put back. A
+        // game that takes that many frames to react to input shows the
+        // reaction straight away, for that many times the emulation work
+        void run(std::shared_ptr<const Cartridge> cartridge, const char *savePath = NULL, int runAheadFrames = 0);
+
+        // Run the given number of frames as fast as possible, with no window
+        // or audio device, and write the audio to a WAV file. The same ROM
+        // and number of frames always makes the same file
+        bool renderAudio(std::shared_ptr<const Cartridge> cartridge, int frames, const char *wavPath);
+
+        // Run the given number of frames as fast as possible, with no window
+        // or audio device, drawing every one. Returns the seconds per frame
+        double benchmark(std::shared_ptr<const Cartridge> cartridge, int frames);
+
+        // Print how full the audio buffer is and the latency once a second
+        void setShowAudioStats(bool show);
+
+        // Dynamic rate control (see Apu::controlRate) is on by default.
+        // Without it the output rate stays fixed, and the buffer drifts
+        void setRateControl(bool enabled);
+
+        // Everything the emulation depends on (see savestate.h). Loading
+        // returns false if the state doesn't fit, which leaves the instance
+        // in no fit state to run until it is loaded or reset again
+        void saveState(std::vector<Byte> &state);
+        bool loadState(const Byte *data, size_t size);
+
+        // The same with what is on the screen, in a file for the ROM that is
+        // loaded. Loading a state that isn't for this ROM, renderer and
+        // version of the format fails before anything is changed, and one
+        // that turns out to be damaged is undone
+        bool saveStateFile(const char *path);
+        bool loadStateFile(const char *path);
 
     private:
+        Core *core;
         Mmu *mmu;
         Cpu *cpu;
         Display *display;
 
+        Ppu<Renderer> ppu;
+
         SDL_Window *window;
         SDL_Renderer *renderer;
 
-        // int timerCounter = 1024; // initial value, frequency 4096 (4194304/4096)
-        int timerCounter = 0;
-        int dividerCounter = 0; // Counts up to 255
-        int scanlineCounter = 456; // It takes 456 clock cycles to draw one scanline
+        // Plays the samples the APU puts in its ring buffer (see apu.h)
+        SDL_AudioDeviceID audioDevice = 0;
+        bool showAudioStats = false;
+        bool rateControl = true;
 
-        bool isClockEnabled();
-        int getClockFrequency();
-        void updateDividerCounter(int cycles);
+        // The state without the screen, for both kinds of state above
+        void saveState(StateWriter &state);
+        void loadState(StateReader &state);
 
-        int update();
-        void updateGraphics(int cycles);
-        void updateTimers(int cycles);
+        // Run a frame and show it (or with run-ahead, the frame that far
+        // ahead, see run)
+        int update(int runAheadFrames, std::vector<Byte> &state, RunAheadStats &stats);
+        void runAhead(int frames, std::vector<Byte> &state, RunAheadStats &stats);
+
+        // Run the CPU (and everything it drives) for a frame, without
+        // drawing it. Returns the cycles run
+        int runFrame();
 
         void doInterrupts();
 
-        bool isLcdEnabled();
-        void setLcdStatus();
+        // Put key presses for the buttons into the joypad's queue. Other keys
+        // save (F5) and load (F8) the state at statePath
+        void handleInput(const SDL_Event &event, const char *statePath);
+
+        // Put a key event for a button into the joypad's queue. Returns false
+        // if the key isn't a button
+        bool queueButton(const SDL_Event &event);
+
+        // Called by the joypad when the game reads P1 (see joypad.h). Takes
+        // the key events SDL has right now
+        static void fetchInput(void *userdata);
+
+        // Handle scheduled events that are due (see scheduler.h)
+        void doEvents();
 
         // GUI - OpenGL/SDL
         bool createWindow();
         void renderGame();
 
+        // Called by SDL on its audio thread whenever the device needs samples
+        bool openAudio();
+        static void audioCallback(void *userdata, Uint8 *stream, int length);
+        void printAudioStats();
+        void printRunAheadStats(int frames, RunAheadStats &stats);
+
         void debugRender();
 
         bool debug = true;
@@ -0,0 +1,133 @@
+#include "joypad.h"
+#include "utils.h"
+
+void Joypad::reset()
+{
+    // Both rows are picked after the boot ROM (P1 reads 0xCF)
+    this->select = 0;
+    this->changed = 0;
+}
+
+Byte Joypad::readRegister()
+{
+    // This is the last moment an input can make a difference to what the
+    // game does, so anything that has come in is taken now. The clock only
+    // goes backwards when a state is loaded, which wraps the difference
+    // around and fetches straight away
+    if (this->polling && this->fetchInput != NULL && this->core->clock - this->lastFetch >= (unsigned long long) JOYPAD_FETCH_CYCLES)
+    {
+        this->lastFetch = this->core->clock;
+        this->fetchInput(this->fetchUserdata);
+    }
+
+    this->pollEvents();
+
+    // Bits 6 and 7 aren't used and always read as 1
+    return 0xC0 | this->select | this->getLines(this->select, this->pressed);
+}
+
+void Joypad::writeRegister(Byte data)
+{
+    // Only the select bits can be written
+    this->setState(data & 0x30, this->pressed);
+}
+
+bool Joypad::pushEvent(const InputEvent &event)
+{
+    return this->events.push(event);
+}
+
+void Joypad::setInputFetcher(void (*fetch)(void *userdata), void *userdata)
+{
+    this->fetchInput = fetch;
+    this->fetchUserdata = userdata;
+}
+
+void Joypad::startFrame()
+{
+    this->changed = 0;
+    this->pollEvents();
+}
+
+void Joypad::setPolling(bool polling)
+{
+    this->polling = polling;
+}
+
+void Joypad::saveState(StateWriter &state)
+{
+    state.put(this->select);
+}
+
+void Joypad::loadState(StateReader &state)
+{
+    state.get(this->select);
+}
+
+void Joypad::pollEvents()
+{
+    if (!this->polling)
+    {
+        return;
+    }
+
+    Byte pressed = this->pressed;
+
+    InputEvent event;
+    while (this->events.peek(event))
+    {
+        Byte bit = 1 << event.button;
+
+        // A second change to the same button waits for the next frame, as
+        // does everything after it so the events stay in order
+        if (this->changed & bit)
+        {
+            break;
+        }
+
+        if (event.pressed != ((pressed & bit) != 0))
+        {
+            pressed ^= bit;
+            this->changed |= bit;
+        }
+
+        this->events.pop(&event, 1);
+    }
+
+    if (pressed != this->pressed)
+    {
+        this->setState(this->select, pressed);
+    }
+}
+
+Byte Joypad::getLines(Byte select, Byte pressed)
+{
+    Byte lines = 0x0F;
+
+    if (!isBitSet(select, 4))
+    {
+        lines &= ~(pressed & 0x0F);
+    }
+
+    if (!isBitSet(select, 5))
+    {
+        lines &= ~(pressed >> 4);
+    }
+
+    return lines;
+}
+
+void Joypad::setState(Byte select, Byte pressed)
+{
+    Byte before = this->getLines(this->select, this->pressed);
+    Byte after = this->getLines(select, pressed);
+
+    this->select = select;
+    this->pressed = pressed;
+
+    // The joypad interrupt (bit 4) is on a line going from 1 to 0
+    if (before & ~after)
+    {
+        this->core->requestInterrupt(4);
+    }
+}
@@ -0,0 +1,118 @@
+/**
+ *
+ * JOYPAD
+ * The 8 buttons are wired as a 2x4 matrix. The game picks a row by writing
+ * 0 to bit 4 (directions) or bit 5 (A, B, Select, Start) of P1 (0xFF00), and
+ * reads the row back in bits 0 - 3, where 0 is pressed. If both rows are
+ * picked, a button in either pulls the line low. Any line going from high
+ * to low requests the joypad interrupt (bit 4).
+ *
+ * The host doesn't change the buttons directly. It puts each key going up
+ * or down into a ring buffer (see ringbuffer.h), which the emulation takes
+ * them from at the start of each frame (so a game waiting in HALT for the
+ * interrupt gets it) and whenever the game reads P1.
+ *
+ * The event loop only runs between frames, so when the game reads P1 the
+ * joypad also asks the host to fetch whatever input it has right then (see
+ * setInputFetcher). That pulls in a key that went down while the frame was
+ * being run, rather than leaving it for the next frame. Fetching costs a
+ * trip to the window system, and some games read P1 in a tight loop, so it
+ * happens at most once every JOYPAD_FETCH_CYCLES.
+ *
+ * A button only changes once a frame. If a press and its release are both
+ * waiting (a tap shorter than a frame), the release waits for the next frame
+ * so the game has a chance to see the press
+ *
+ **/
+
+#ifndef __JOYPAD_H_INCLUDED__
+#define __JOYPAD_H_INCLUDED__
+
+#include "core.h"
+#include "ringbuffer.h"
+#include "savestate.h"
+#include "utils.h"
+
+// The bit of each button in the pressed mask. The directions are the bottom
+// 4 bits and the other buttons the top 4, each in P1's order
+enum JoypadButton {
+    BUTTON_RIGHT,
+    BUTTON_LEFT,
+    BUTTON_UP,
+    BUTTON_DOWN,
+    BUTTON_A,
+    BUTTON_B,
+    BUTTON_SELECT,
+    BUTTON_START
+};
+
+// A button going down or up
+struct InputEvent {
+    Byte button;
+    bool pressed;
+};
+
+class Joypad {
+
+    public:
+        Joypad(Core *_core) : core(_core), events(JOYPAD_QUEUE_EVENTS) {};
+
+        // The buttons held on the host stay held through a reset
+        void reset();
+
+        // 0xFF00
+        Byte readRegister();
+        void writeRegister(Byte data);
+
+        // Called by the host (the producer). Returns false (and drops the
+        // event) if the queue is full
+        bool pushEvent(const InputEvent &event);
+
+        // Called when the game reads P1, to push anything new from the host
+        // into the queue. NULL to stop
+        void setInputFetcher(void (*fetch)(void *userdata), void *userdata);
+
+        // Called at the start of each frame, before it is run
+        void startFrame();
+
+        // While not polling, the buttons stay as they are and events wait in
+        // the queue (for frames that are run ahead and thrown away)
+        void setPolling(bool polling);
+
+        // Only the select lines. The buttons are whatever the host is holding
+        void saveState(StateWriter &state);
+        void loadState(StateReader &state);
+
+    private:
+        Core *core;
+
+        // Bits 4 and 5 of P1 as the game wrote them
+        Byte select = 0;
+
+        // 1 for each button held (see JoypadButton), and each button that
+        // has changed this frame
+        Byte pressed = 0;
+        Byte changed = 0;
+
+        bool polling = true;
+
+        void (*fetchInput)(void *userdata) = NULL;
+        void *fetchUserdata = NULL;
+
+        // The clock when input was last fetched
+        unsigned long long lastFetch = 0;
+
+        RingBuffer<InputEvent> events;
+
+        // Take what is waiting in the queue
+        void pollEvents();
+
+        // Bits 0 - 3 of P1 (0 is pressed) for the buttons and the rows picked
+        Byte getLines(Byte select, Byte pressed);
+
+        // Change the rows picked and/or the buttons held, requesting the
+        // interrupt if a line goes low
+        void setState(Byte select, Byte pressed);
+};
+
+#endif
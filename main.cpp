@@ -5,6 +5,9 @@
 #include <iostream>
 #include <fstream>
 
+#include "arena.h"
+#include "cartridge.h"
+#include "core.h"
 #include "cpu.h"
 #include "display.h"
 #include "gameboy.h"
@@ -13,29 +16,136 @@
 
 using namespace std;
 
-void loadGame(Byte *cartridge, const char *rom)
+int main(int argc, char **argv)
 {
-    FILE *in;
-    in = fopen(rom, "rb");
-    fread(cartridge, 1, CARTRIDGE_SIZE, in);
-    fclose(in);
-}
+    // gameboy [rom]                       - play the ROM
+    // gameboy --run-ahead frames [rom]    - play it that many frames ahead
+    //                                       to hide the game's input lag
+    // gameboy --wav out.wav seconds [rom] - write its audio to out.wav as
+    //                                       fast as possible, with no window
+    // gameboy --bench frames [rom]        - run that many frames with each
+    //                                       renderer as fast as possible, with
+    //                                       no window, and print the time each
+    //                                       frame took
+    // gameboy --audio-stats [rom]         - print how full the audio buffer
+    //                                       is and the latency once a second
+    // gameboy --no-rate-control [rom]     - don't nudge the audio rate to
+    //                                       keep the buffer steady
+    //
+    // The options can be combined, i.e. --run-ahead 1 --audio-stats [rom]
+    const char *wavPath = NULL;
+    double wavSeconds = 0;
+    int runAheadFrames = 0;
+    int benchFrames = 0;
+    bool showAudioStats = false;
+    bool rateControl = true;
+    const char *romPath = "rom/instr_timing/instr_timing.gb";
 
-int main()
-{
-    unique_ptr<Mmu> u_mmu = make_unique<Mmu>();
-    unique_ptr<Cpu> u_cpu = make_unique<Cpu>(u_mmu.get());
-    unique_ptr<Display> u_display = make_unique<Display>(u_mmu.get());
+    int arg = 1;
+    while (argc > arg)
+    {
+        if (argc > arg + 2 && strcmp(argv[arg], "--wav") == 0)
+        {
+            wavPath = argv[arg + 1];
+            wavSeconds = atof(argv[arg + 2]);
+            arg += 3;
+        }
+        else if (argc > arg + 1 && strcmp(argv[arg], "--run-ahead") == 0)
+        {
+            runAheadFrames = atoi(argv[arg + 1]);
+            arg += 2;
+        }
+        else if (argc > arg + 1 && strcmp(argv[arg], "--bench") == 0)
+        {
+            benchFrames = atoi(argv[arg + 1]);
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--audio-stats") == 0)
+        {
+            showAudioStats = true;
+            arg += 1;
+        }
+        else if (strcmp(argv[arg], "--no-rate-control") == 0)
+        {
+            rateControl = false;
+            arg += 1;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (argc > arg)
+    {
+        romPath = argv[arg];
+    }
+
+    // Everything the instance needs is allocated together from one arena, core
+    // block first, so the hot state is in adjacent cache lines. A pool of
+    // instances would size the arena for all of them and ask for huge pages
+    size_t instanceSize = sizeof(Core) + sizeof(Cpu) + sizeof(Mmu) + sizeof(Display) + 4 * CACHE_LINE_SIZE;
+    Arena arena(instanceSize);
+
+    Core *core = arena.create<Core>();
+    Mmu *mmu = arena.create<Mmu>(core);
+    Cpu *cpu = arena.create<Cpu>(mmu, core);
+    Display *display = arena.create<Display>(mmu);
+
+    // Shades are shown in grey by default. Use OUTPUT_PALETTE_GREEN
+    // for the look of the original screen
+    display->setOutputPalette(OUTPUT_PALETTE_GREY);
 
-    Gameboy gb(u_mmu.get(), u_cpu.get(), u_display.get());
+    // The scanline renderer is fast. Use Gameboy<PixelFifoRenderer> for
+    // games that change registers part way through a line
+    Gameboy<ScanlineRenderer> gb(core, mmu, cpu, display);
 
-    // A gameboy cartridge (ROM) has 0x200000 bytes of memory
+    gb.setShowAudioStats(showAudioStats);
+    gb.setRateControl(rateControl);
+
+    // A gameboy cartridge (ROM) has up to 0x200000 bytes of memory
     // Not all of this memory is loaded into system memory at
     // one given moment (necessarily). Only 0x8000 bytes are stored
-    // in memoery at a given time so store the ROM memory separately
-    Byte cartridge[CARTRIDGE_SIZE];
-    memset(cartridge, 0, sizeof(cartridge));
-    loadGame(cartridge, "rom/instr_timing/instr_timing.gb");
+    // in memoery at a given time so store the ROM memory separately.
+    // The image is shared by every instance running the same ROM
+    shared_ptr<const Cartridge> cartridge = Cartridge::load(romPath);
+    if (!cartridge)
+    {
+        cout << "Unable to load ROM" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Rendering audio doesn't use the save file or the host's clock, so
+    // the output only depends on the ROM
+    if (wavPath != NULL)
+    {
+        int frames = (int) (wavSeconds * CLOCK_SPEED / MAX_CYCLES_PER_FRAME);
+        return gb.renderAudio(cartridge, frames, wavPath) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Like rendering audio, a benchmark only depends on the ROM. The pixel
+    // FIFO renderer needs an instance of its own
+    if (benchFrames > 0)
+    {
+        double scanlineSeconds = gb.benchmark(cartridge, benchFrames);
+
+        Arena fifoArena(instanceSize);
+        Core *fifoCore = fifoArena.create<Core>();
+        Mmu *fifoMmu = fifoArena.create<Mmu>(fifoCore);
+        Cpu *fifoCpu = fifoArena.create<Cpu>(fifoMmu, fifoCore);
+        Display *fifoDisplay = fifoArena.create<Display>(fifoMmu);
+        Gameboy<PixelFifoRenderer> fifo(fifoCore, fifoMmu, fifoCpu, fifoDisplay);
+        double fifoSeconds = fifo.benchmark(cartridge, benchFrames);
+
+        printf("%d frames\n", benchFrames);
+        printf("Scanline:   %.3f ms per frame (%.0f fps)\n", scanlineSeconds * 1000, 1 / scanlineSeconds);
+        printf("Pixel FIFO: %.3f ms per frame (%.0f fps)\n", fifoSeconds * 1000, 1 / fifoSeconds);
+        return EXIT_SUCCESS;
+    }
+
+    // Cartridges with a battery keep their RAM (and clock) in a save file
+    // next to the ROM. When playing, the clock should follow real time
+    mmu->getRtc()->setUseHostTime(true);
 
     // This is just a debug loop to see if data was loaded into
     // memory correctly - print out some instructions (start where PC would be)
@@ -45,9 +155,11 @@ int main()
     //     cout << "0x" << std::hex << address << endl;
     // }
 
-    // TODO we need to deal with the joypad
+    // The arrow keys are the D-pad, X is A, Z is B, Enter is Start and
+    // Backspace (or right shift) is Select. F5 saves the state next to the
+    // ROM and F8 loads it
 
-    gb.run(cartridge);
+    gb.run(cartridge, cartridge->getSavePath().c_str(), runAheadFrames);
 
     return EXIT_SUCCESS;
 }
@@ -8,122 +8,205 @@
 
 using namespace std;
 
-void Mmu::loadRom(Byte *cartridge)
+static_assert(sizeof(Mmu) <= MMU_SIZE_BUDGET, "Mmu is over its memory budget");
+
+void Mmu::loadRom(std::shared_ptr<const Cartridge> cartridge)
 {
+    // The cartridge image is shared with any other instance running the same
+    // ROM. ROM banks 0 and 1 are read directly from it, so there is nothing to
+    // copy into memory
     this->cartridge = cartridge;
-
-    // Load ROM banks 0 and 1 into memory
-    for (int i = 0; i < MEMORY_ROM_SIZE; i++)
-    {
-        this->memory[i] = cartridge[i];
-    }
-
-    // for (int i = 0x8210; i <= 0x821F; i++)
-    // {
-    //     // cout << "0x" << std::hex << this->memory[i] << " ";
-    //     printf("0x%.4x: 0x%.2x\n", i, this->memory[i]);
-    // }
-
-    // Once we load the ROM, we need to determine the current bank mode
-    // and set the appropriate flag. Memory address 0x147 specifies the current
-    // bank mode. If the value is 0, MBC is 0. If it is 1, 2 or 3 it is MBC1 and
-    // 5 or 6 specifies MBC2
-    switch (this->memory[ROM_BANKING_MODE_ADDR])
-    {
-        case 1: this->mbc1 = true; break;
-        case 2: this->mbc1 = true; break;
-        case 3: this->mbc1 = true; break;
-        case 5: this->mbc2 = true; break;
-        case 6: this->mbc2 = true; break;
-        default: break;
-    }
+    this->rom = cartridge->getRom();
+    this->romBankMask = cartridge->getBankMask();
 }
 
 void Mmu::reset()
 {
     // This is the initial state of the Mmu
-    this->memory[0xFF05] = 0x00;
-    this->memory[0xFF06] = 0x00;
-    this->memory[0xFF07] = 0x00;
-    this->memory[0xFF10] = 0x80;
-    this->memory[0xFF11] = 0xBF;
-    this->memory[0xFF12] = 0xF3;
-    this->memory[0xFF14] = 0xBF;
-    this->memory[0xFF16] = 0x3F;
-    this->memory[0xFF17] = 0x00;
-    this->memory[0xFF19] = 0xBF;
-    this->memory[0xFF1A] = 0x7F;
-    this->memory[0xFF1B] = 0xFF;
-    this->memory[0xFF1E] = 0xBF;
-    this->memory[0xFF20] = 0xFF;
-    this->memory[0xFF21] = 0x00;
-    this->memory[0xFF22] = 0x00;
-    this->memory[0xFF23] = 0xBF;
-    this->memory[0xFF24] = 0x77;
-    this->memory[0xFF25] = 0xF3;
-    this->memory[0xFF26] = 0xF1;
-    this->memory[0xFF40] = 0x91;
-    this->memory[0xFF42] = 0x00;
-    this->memory[0xFF43] = 0x00;
-    this->memory[0xFF45] = 0x00;
-    this->memory[0xFF47] = 0xFC;
-    this->memory[0xFF48] = 0xFF;
-    this->memory[0xFF49] = 0xFF;
-    this->memory[0xFF4A] = 0x00;
-    this->memory[0xFF4B] = 0x00;
-    this->memory[0xFFFF] = 0x00;
-
-    // THIS IS A TEMPORARY HACK FOR INPUT AS WE HAVE YET TO IMPLEMENT JOYPAD
-    // this->memory[JOYPAD_REGISTER_ADDR] = 0x2F; // This will set all inputs to unpressed - might be necessary to avoid reset loops for games like Tetris
+    memset(this->highMemory, 0, sizeof(this->highMemory));
+    this->highMemory[0xFF40 - HIGH_MEMORY_START] = 0x91;
+    this->highMemory[0xFF42 - HIGH_MEMORY_START] = 0x00;
+    this->highMemory[0xFF43 - HIGH_MEMORY_START] = 0x00;
+    this->highMemory[0xFF45 - HIGH_MEMORY_START] = 0x00;
+    this->highMemory[0xFF47 - HIGH_MEMORY_START] = 0xFC;
+    this->highMemory[0xFF48 - HIGH_MEMORY_START] = 0xFF;
+    this->highMemory[0xFF49 - HIGH_MEMORY_START] = 0xFF;
+    this->highMemory[0xFF4A - HIGH_MEMORY_START] = 0x00;
+    this->highMemory[0xFF4B - HIGH_MEMORY_START] = 0x00;
+    this->highMemory[0xFFFF - HIGH_MEMORY_START] = 0x00;
 
     this->currentRomBank = 1;
     this->currentRamBank = 0;
 
-    // Re-initialize RAM to 0
-    memset(&(this->ramBanks), 0, sizeof(this->ramBanks));
+    memset(this->videoRam, 0, sizeof(this->videoRam));
+    this->tileCache.reset(this->videoRam);
+    memset(this->workRam, 0, sizeof(this->workRam));
+
+    // Re-initialize RAM to 0, unless it is the battery save which
+    // should survive a reset
+    if (!this->saveFile.isOpen())
+    {
+        memset(this->ramBuffer, 0, sizeof(this->ramBuffer));
+    }
 
     this->romBanking = true;
     this->enableRam = false;
+
+    this->rtc.reset();
+    this->lastLatchWrite = 0xFF;
+    this->core->clock = 0;
+
+    this->core->scheduler.reset();
+    this->dmaActive = false;
+    this->timer.reset();
+    this->apu.reset();
+    this->joypad.reset();
+
+    this->core->setInterruptEnable(0);
+    this->core->setInterruptRequest(0);
+    this->core->currentScanline = 0;
+
+    // Anything the display derived from the palettes, VRAM and OAM is out of date
+    this->notifyPaletteChanged(BACKGROUND_COLOR_PALETTE_ADDR);
+    this->notifyPaletteChanged(SPRITE_COLOR_PALETTE_1_ADDR);
+    this->notifyPaletteChanged(SPRITE_COLOR_PALETTE_2_ADDR);
+    if (this->videoObserver != NULL)
+    {
+        this->videoObserver->videoMemoryReset();
+        this->videoObserver->spritesChanged();
+    }
+
+    this->updatePageTable();
 }
 
 Byte Mmu::readMemory(Word address)
 {
+    // Most reads are from a page that has no side effects, which the
+    // page table lets us read directly
+    const Byte *page = this->core->readPages[address >> 12];
+    if (page != NULL)
+    {
+        return page[address & 0xFFF];
+    }
+
+    // During DMA, the CPU only sees 0xFF on the bus being copied from
+    if (this->dmaActive && this->isDmaBlocked(address))
+    {
+        return 0xFF;
+    }
+
+    // ROM bank 0 is always the start of the cartridge
+    if (address < 0x4000)
+    {
+        return this->rom[address];
+    }
+
     // If we are reading from ROM banks, ensure we read from the correct bank
     // We do this instead of swapping memory from cartridge into internal memory
     // TODO Is this the best way? Or should we do the swap?
-    if (address >= 0x4000 && address < 0x8000)
+    else if (address >= 0x4000 && address < 0x8000)
+    {
+        return *(this->rom + (address - 0x4000) + ((this->currentRomBank & this->romBankMask) * ROM_BANK_SIZE));
+    }
+
+    else if (address >= 0x8000 && address < 0xA000)
     {
-        return *(this->cartridge + (address - 0x4000) + ((this->currentRomBank) * 0x4000));
+        return this->videoRam[address - VIDEO_RAM_START];
     }
 
     // If we are reading from RAM than we should get data in appropriate RAM bank
     else if (address >= 0xA000 && address < 0xC000)
     {
-        return this->ramBanks[(address - 0xA000) + (this->currentRamBank * RAM_BANK_SIZE)];
+        // MBC3 can map one of the clock registers here instead of RAM
+        if (this->currentRamBank >= RTC_REGISTER_SELECT_MIN)
+        {
+            return this->rtc.readRegister(this->currentRamBank);
+        }
+
+        return this->ramBanks[((address - 0xA000) + (this->currentRamBank * RAM_BANK_SIZE)) & this->ramMask];
+    }
+
+    // Work RAM, which ECHO (0xE000 - 0xFDFF) mirrors
+    else if (address >= 0xC000 && address < 0xFE00)
+    {
+        return this->workRam[(address - WORK_RAM_START) & (WORK_RAM_SIZE - 1)];
+    }
+
+    // These registers are kept in the core block
+    else if (address == INTERRUPT_REQUEST_ADDR)
+    {
+        return this->core->interruptRequest;
+    }
+    else if (address == INTERRUPT_ENABLED_REGISTER)
+    {
+        return this->core->interruptEnable;
+    }
+    else if (address == CURRENT_SCANLINE_ADDR)
+    {
+        this->syncVideo();
+        return this->core->currentScanline;
+    }
+
+    // The timer registers are worked out from the clock
+    else if (address >= DIVIDER_REGISTER_ADDR && address <= TIMER_CONTROLLER_ADDR)
+    {
+        return this->timer.readRegister(address);
+    }
+
+    // The sound registers
+    else if (address >= SOUND_REGISTERS_START && address <= SOUND_REGISTERS_END)
+    {
+        return this->apu.readRegister(address);
+    }
+
+    // The buttons in the row(s) the game has picked
+    else if (address == JOYPAD_REGISTER_ADDR)
+    {
+        return this->joypad.readRegister();
+    }
+
+    // The mode and coincidence flag in the LCD status come from the PPU
+    // state. Bit 7 always reads as 1
+    else if (address == LCD_STATUS_ADDR)
+    {
+        this->syncVideo();
+        Byte lcdStatus = 0x80 | (this->highMemory[address - HIGH_MEMORY_START] & 0b01111000) | this->core->lcdMode;
+        if (this->core->currentScanline == this->highMemory[LYC_ADDR - HIGH_MEMORY_START])
+        {
+            setBit(&lcdStatus, 2);
+        }
+
+        return lcdStatus;
     }
 
     // Otherwise just return what's at memory
-    return this->memory[address];
+    return this->highMemory[address - HIGH_MEMORY_START];
 }
 
 void Mmu::writeMemory(Word address, Byte data)
 {
+    // During DMA, writes to the bus being copied from are lost
+    if (this->dmaActive && this->isDmaBlocked(address))
+    {
+        return;
+    }
+
+    // The PPU has to have drawn everything up to now with the old value
+    if (this->isVideoAddress(address))
+    {
+        this->syncVideo();
+    }
+
     // Debug
     // if (address == 0xFF02)
     // {
 	// 	// printf("0x%.2x\n", data);
     //     if (data == 0x81)
     //     {
-    //         cout << this->memory[0xFF01];
+    //         cout << this->highMemory[0xFF01 - HIGH_MEMORY_START];
     //     }
 	// }
 
-    // if (address == JOYPAD_REGISTER_ADDR)
-    // {
-    //     // printf("WRITING 0x%.4x: 0x%.2x 0x%.2x\n", address, data, this->memory[address]);
-    //     return;
-    // }
-
     // We cannot write to memory 0x0000 - 0x7FFF
     // As this is read only game data
     if (address < 0x8000)
@@ -132,47 +215,249 @@ void Mmu::writeMemory(Word address, Byte data)
         this->handleBanking(address, data);
     }
 
+    // Writing to external RAM only works if the game has enabled it, and
+    // it goes to the currently selected bank (or clock register for MBC3)
+    else if (address >= 0xA000 && address < 0xC000)
+    {
+        if (this->enableRam)
+        {
+            if (this->currentRamBank >= RTC_REGISTER_SELECT_MIN)
+            {
+                this->rtc.writeRegister(this->currentRamBank, data, this->core->clock);
+            }
+            else
+            {
+                this->ramBanks[((address - 0xA000) + (this->currentRamBank * RAM_BANK_SIZE)) & this->ramMask] = data;
+                this->saveFile.markDirty();
+            }
+        }
+    }
+
     // If we are writing to ECHO (E000-FDFF) we must write to working RAM (C000-CFFF) as well
     else if (address >= 0xE000 && address < 0xFE00)
     {
         if (this->enableRam)
         {
-            this->memory[address] = data;
             this->writeMemory(address - 0x2000, data);
         }
     }
 
+    // The display keeps a list of sprites from OAM
+    else if (address >= SPRITE_ATTRIBUTE_TABLE_ADDR && address < SPRITE_ATTRIBUTE_TABLE_ADDR + OAM_SIZE)
+    {
+        this->notifyVideoMemoryWillChange(address);
+        this->highMemory[address - HIGH_MEMORY_START] = data;
+        if (this->videoObserver != NULL)
+        {
+            this->videoObserver->spritesChanged();
+        }
+    }
+
     // Do not allow writing to restricted area (FEA0-FEFF)
     else if (address >= 0xFEA0 && address < 0xFF00)
     {
         // cout << "Attemped to write to restricted address 0x" << std::hex << address << endl;
     }
 
-    // We cannot write here directly - reset to 0
-    else if (address == DIVIDER_REGISTER_ADDR || address == CURRENT_SCANLINE_ADDR)
+    // The timer registers (writing DIV resets it to 0)
+    else if (address >= DIVIDER_REGISTER_ADDR && address <= TIMER_CONTROLLER_ADDR)
+    {
+        this->timer.writeRegister(address, data);
+    }
+    else if (address >= SOUND_REGISTERS_START && address <= SOUND_REGISTERS_END)
+    {
+        this->apu.writeRegister(address, data);
+    }
+    else if (address == JOYPAD_REGISTER_ADDR)
+    {
+        this->joypad.writeRegister(data);
+    }
+    else if (address == CURRENT_SCANLINE_ADDR)
+    {
+        this->core->currentScanline = 0;
+    }
+
+    // These change what the PPU should be doing, so let it catch up straight
+    // away rather than at its next mode change (see ppu.h). Only the LCD
+    // being turned on or off matters for the LCD control
+    else if (address == LCD_CONTROL_ADDR)
+    {
+        if ((this->highMemory[address - HIGH_MEMORY_START] ^ data) & 0x80)
+        {
+            this->core->scheduler.schedule(EVENT_PPU, this->core->clock);
+        }
+
+        this->highMemory[address - HIGH_MEMORY_START] = data;
+    }
+    else if (address == LCD_STATUS_ADDR || address == LYC_ADDR)
+    {
+        this->highMemory[address - HIGH_MEMORY_START] = data;
+        this->core->scheduler.schedule(EVENT_PPU, this->core->clock);
+    }
+
+    else if (address == INTERRUPT_REQUEST_ADDR)
     {
-        this->memory[address] = 0;
+        this->core->setInterruptRequest(data);
+    }
+    else if (address == INTERRUPT_ENABLED_REGISTER)
+    {
+        this->core->setInterruptEnable(data);
     }
 
     // If we attempt to write to this address, this is the game launching a DMA (Direct Memory Access)
     // which is a way of copying data to the Sprite RAM
-    else if (address == 0xFF46)
+    else if (address == DMA_ADDR)
     {
+        // The register reads back as the last value written
+        this->highMemory[address - HIGH_MEMORY_START] = data;
         this->doDmaTransfer(data);
     }
 
-    // If we are changing the data of the timer controller, then the timer itself will need
-    // to reset to count at the new frequency being set here
-    else if (address == TIMER_CONTROLLER_ADDR)
+    // The display keeps a lookup table for each palette
+    else if (address >= BACKGROUND_COLOR_PALETTE_ADDR && address <= SPRITE_COLOR_PALETTE_2_ADDR)
     {
-        this->setTimerFrequencyChanged(true);
-        this->memory[address] = data;
+        this->highMemory[address - HIGH_MEMORY_START] = data;
+        this->notifyPaletteChanged(address);
     }
 
     // Anywhere else is safe to write
+    else if (address >= 0x8000 && address < 0xA000)
+    {
+        this->notifyVideoMemoryWillChange(address);
+        this->videoRam[address - VIDEO_RAM_START] = data;
+        this->tileCache.update(this->videoRam, address - VIDEO_RAM_START);
+    }
+    else if (address >= 0xC000 && address < 0xE000)
+    {
+        this->workRam[address - WORK_RAM_START] = data;
+    }
     else
     {
-        this->memory[address] = data;
+        this->highMemory[address - HIGH_MEMORY_START] = data;
+    }
+}
+
+void Mmu::saveState(StateWriter &state)
+{
+    state.write(this->videoRam, sizeof(this->videoRam));
+    state.write(this->workRam, sizeof(this->workRam));
+    state.write(this->highMemory, sizeof(this->highMemory));
+
+    // As much external RAM as the cartridge has
+    unsigned int ramSize = this->ramMask + 1;
+    state.put(ramSize);
+    state.write(this->ramBanks, ramSize);
+
+    state.put(this->currentRomBank);
+    state.put(this->currentRamBank);
+    state.put(this->romBanking);
+    state.put(this->enableRam);
+    state.put(this->lastLatchWrite);
+    state.put(this->dmaActive);
+    state.put(this->dmaFromVideoRam);
+
+    this->rtc.saveState(state);
+    this->timer.saveState(state);
+    this->apu.saveState(state);
+    this->joypad.saveState(state);
+}
+
+void Mmu::loadState(StateReader &state)
+{
+    state.read(this->videoRam, sizeof(this->videoRam));
+    state.read(this->workRam, sizeof(this->workRam));
+    state.read(this->highMemory, sizeof(this->highMemory));
+
+    unsigned int ramSize;
+    state.get(ramSize);
+    if (ramSize != (unsigned int) (this->ramMask + 1))
+    {
+        state.fail();
+        return;
+    }
+
+    // Loading the state run-ahead saved (the usual case) leaves the RAM as
+    // it is, and then the save file has nothing new to be flushed
+    const Byte *ram = state.readBlock(ramSize);
+    if (ram != NULL && memcmp(this->ramBanks, ram, ramSize) != 0)
+    {
+        memcpy(this->ramBanks, ram, ramSize);
+        if (this->saveFile.isOpen())
+        {
+            this->saveFile.markDirty();
+        }
+    }
+
+    state.get(this->currentRomBank);
+    state.get(this->currentRamBank);
+    state.get(this->romBanking);
+    state.get(this->enableRam);
+    state.get(this->lastLatchWrite);
+    state.get(this->dmaActive);
+    state.get(this->dmaFromVideoRam);
+
+    this->rtc.loadState(state);
+    this->timer.loadState(state);
+    this->apu.loadState(state);
+    this->joypad.loadState(state);
+
+    // Everything worked out from VRAM, OAM and the palettes has to be again
+    this->tileCache.reset(this->videoRam);
+    this->notifyPaletteChanged(BACKGROUND_COLOR_PALETTE_ADDR);
+    this->notifyPaletteChanged(SPRITE_COLOR_PALETTE_1_ADDR);
+    this->notifyPaletteChanged(SPRITE_COLOR_PALETTE_2_ADDR);
+    if (this->videoObserver != NULL)
+    {
+        this->videoObserver->videoMemoryReset();
+        this->videoObserver->spritesChanged();
+    }
+
+    this->updatePageTable();
+}
+
+void Mmu::updatePageTable()
+{
+    const Byte **pages = this->core->readPages;
+
+    // ROM bank 0 and the switchable ROM bank
+    for (int i = 0; i < 4; i++)
+    {
+        pages[i] = this->rom + (i * 0x1000);
+        pages[i + 4] = this->cartridge->getBank(this->currentRomBank) + (i * 0x1000);
+    }
+
+    pages[0x8] = this->videoRam;
+    pages[0x9] = this->videoRam + 0x1000;
+
+    // External RAM can only be read directly if it is a RAM bank (not the
+    // clock) and is big enough to fill the page
+    pages[0xA] = NULL;
+    pages[0xB] = NULL;
+    if (this->currentRamBank < RTC_REGISTER_SELECT_MIN && this->ramMask >= 0xFFF)
+    {
+        int bankStart = this->currentRamBank * RAM_BANK_SIZE;
+        pages[0xA] = this->ramBanks + (bankStart & this->ramMask);
+        pages[0xB] = this->ramBanks + ((bankStart + 0x1000) & this->ramMask);
+    }
+
+    // Work RAM, and the first page of ECHO. The rest of ECHO shares a page
+    // with OAM and the I/O ports so is read through the MMU
+    pages[0xC] = this->workRam;
+    pages[0xD] = this->workRam + 0x1000;
+    pages[0xE] = this->workRam;
+    pages[0xF] = NULL;
+
+    // Pages on the bus that a DMA transfer is using have to go through the
+    // MMU so that they can be blocked
+    if (this->dmaActive)
+    {
+        for (int i = 0; i < 0xF; i++)
+        {
+            if (this->isDmaBlocked(i << 12))
+            {
+                pages[i] = NULL;
+            }
+        }
     }
 }
 
@@ -180,14 +465,14 @@ void Mmu::handleBanking(Word address, Byte data)
 {
     // If the address is between 0x0000 and 0x2000, and ROM Banking is enabled
     // then we attempt RAM enabling
-    if (address < 0x2000 && (this->mbc1 || this->mbc2))
+    if (address < 0x2000 && this->cartridge->getMbc() != MBC_NONE)
     {
         this->doEnableRamBanking(address, data);
     }
 
     // If the address is between 0x2000 and 0x4000, and ROM banking is enabled
     // then we perform a ROM bank change
-    else if (address >= 0x2000 && address < 0x4000 && (this->mbc1 || this->mbc2))
+    else if (address >= 0x2000 && address < 0x4000 && this->cartridge->getMbc() != MBC_NONE)
     {
         this->doRomLoBankChange(data);
     }
@@ -198,7 +483,7 @@ void Mmu::handleBanking(Word address, Byte data)
     else if (address >= 0x4000 && address < 0x6000)
     {
         //  MBC2 does not have Rambank so we always use 0 and don't have to change
-        if (this->mbc1)
+        if (this->cartridge->getMbc() == MBC_1)
         {
             if (this->romBanking)
             {
@@ -209,16 +494,31 @@ void Mmu::handleBanking(Word address, Byte data)
                 this->doRamBankChange(data);
             }
         }
+
+        // MBC3 always selects a RAM bank (or RTC register) here
+        else if (this->cartridge->getMbc() == MBC_3)
+        {
+            this->doRamBankChange(data);
+        }
     }
 
     // In MBC1, rom banking is flipped depending on data to signify
     // a RAM banking change instead. If we are writing to an address
     // between 0x6000 and 0x8000 that is how we know if we should change
     // this flag or not
-    else if (address >= 0x6000 && address < 0x8000 && this->mbc1)
+    else if (address >= 0x6000 && address < 0x8000 && this->cartridge->getMbc() == MBC_1)
     {
         this->doChangeRomRamMode(data);
     }
+
+    // In MBC3 this same range is used to latch the clock registers
+    else if (address >= 0x6000 && address < 0x8000 && this->cartridge->getMbc() == MBC_3)
+    {
+        this->doRtcLatch(data);
+    }
+
+    // Any of the above could have changed what is mapped in
+    this->updatePageTable();
 }
 
 void Mmu::doEnableRamBanking(Word address, Byte data)
@@ -229,7 +529,7 @@ void Mmu::doEnableRamBanking(Word address, Byte data)
     // is 0xA. If it is, we enable RAM bank writing. If it is 0 instead, we
     // disable RAM bank writing. Additionally, for MBC2, if the address byte
     // does not have a zero in bit 4, we do nothing.
-    if (this->mbc2 && isBitSet(address, 4)) return;
+    if (this->cartridge->getMbc() == MBC_2 && isBitSet(address, 4)) return;
 
     // Test the lower 4 bits
     if ((data & 0xF) == 0xA)
@@ -238,6 +538,13 @@ void Mmu::doEnableRamBanking(Word address, Byte data)
     }
     else if ((data & 0xF) == 0)
     {
+        // Games disable RAM once they are done saving, so this is
+        // a good time to get the save onto disk
+        if (this->enableRam)
+        {
+            this->flushBatteryData();
+        }
+
         this->enableRam = false;
     }
 }
@@ -250,7 +557,7 @@ void Mmu::doRomLoBankChange(Byte data)
     // MBC1, we should change the lower 5 bits (0-4) and if we are using
     // MBC2, we change the lower 4 (0-3)
 
-    if (this->mbc1)
+    if (this->cartridge->getMbc() == MBC_1)
     {
         // We need to makesure we don't touch the upper 3 bits here as they
         // Will be handled later
@@ -259,12 +566,18 @@ void Mmu::doRomLoBankChange(Byte data)
         this->currentRomBank |= lower5;
     }
 
-    else if (this->mbc2)
+    else if (this->cartridge->getMbc() == MBC_2)
     {
         // MBC2 does not ever need the upper bits so we can ignore them
         this->currentRomBank = data & 0xF;
     }
 
+    else if (this->cartridge->getMbc() == MBC_3)
+    {
+        // MBC3 writes the whole 7 bit bank number at once
+        this->currentRomBank = data & 0x7F;
+    }
+
     // ROM Bank 0 is always in memory 0x000 - 0x4000 so we must ensure that
     // This is at least rom bank 1 or more
     if (this->currentRomBank == 0)
@@ -292,6 +605,17 @@ void Mmu::doRamBankChange(Byte data)
     // RAM banks cannot be changed in MBC2 as there will be external RAM on the cartride
     // in these cases. If ROM banking is false though, then we can set the current RAM bank
     // to the lower 2 bits of data
+    // MBC3 can also select one of the clock registers here with 0x08 - 0x0C
+    if (this->cartridge->getMbc() == MBC_3 && data >= RTC_REGISTER_SELECT_MIN)
+    {
+        if (data <= 0x0C)
+        {
+            this->currentRamBank = data;
+        }
+
+        return;
+    }
+
     this->currentRamBank = data & 0x3;
 }
 
@@ -310,35 +634,220 @@ void Mmu::doChangeRomRamMode(Byte data)
     }
 }
 
-bool Mmu::isTimerFrequencyChanged()
+void Mmu::doRtcLatch(Byte data)
+{
+    // Writing 0x00 and then 0x01 copies the current time into the clock
+    // registers. This is the only point we need to work out what time it is
+    if (this->lastLatchWrite == 0x00 && data == 0x01)
+    {
+        this->rtc.latch(this->core->clock);
+    }
+
+    this->lastLatchWrite = data;
+}
+
+unsigned long long Mmu::getClock()
+{
+    return this->core->clock;
+}
+
+Rtc *Mmu::getRtc()
+{
+    return &(this->rtc);
+}
+
+Timer *Mmu::getTimer()
+{
+    return &(this->timer);
+}
+
+const Cartridge *Mmu::getCartridge()
+{
+    return this->cartridge.get();
+}
+
+Apu *Mmu::getApu()
+{
+    return &(this->apu);
+}
+
+Joypad *Mmu::getJoypad()
+{
+    return &(this->joypad);
+}
+
+void Mmu::setVideoObserver(VideoObserver *observer)
+{
+    this->videoObserver = observer;
+}
+
+void Mmu::setVideoSync(VideoSync *sync)
+{
+    this->videoSync = sync;
+}
+
+bool Mmu::isVideoAddress(Word address)
+{
+    // VRAM, OAM and the LCD registers (0xFF40 - 0xFF4B, including DMA)
+    return (address >= 0x8000 && address < 0xA000)
+        || (address >= SPRITE_ATTRIBUTE_TABLE_ADDR && address < SPRITE_ATTRIBUTE_TABLE_ADDR + OAM_SIZE)
+        || (address >= LCD_CONTROL_ADDR && address <= WINDOW_X_ADDR);
+}
+
+void Mmu::syncVideo()
+{
+    if (this->videoSync != NULL)
+    {
+        this->videoSync->catchUp();
+    }
+}
+
+void Mmu::notifyVideoMemoryWillChange(Word address)
+{
+    if (this->videoObserver != NULL)
+    {
+        this->videoObserver->videoMemoryWillChange(address);
+    }
+}
+
+void Mmu::notifyPaletteChanged(Word address)
+{
+    if (this->videoObserver != NULL)
+    {
+        this->videoObserver->paletteChanged(address, this->highMemory[address - HIGH_MEMORY_START]);
+    }
+}
+
+Byte Mmu::getVideoRegister(Word address)
+{
+    return this->highMemory[address - HIGH_MEMORY_START];
+}
+
+const Byte *Mmu::getOam()
+{
+    return this->highMemory + (SPRITE_ATTRIBUTE_TABLE_ADDR - HIGH_MEMORY_START);
+}
+
+const Byte *Mmu::getVideoRam()
+{
+    return this->videoRam;
+}
+
+const TileCache *Mmu::getTileCache()
+{
+    return &(this->tileCache);
+}
+
+void Mmu::loadBatteryData(const char *path)
+{
+    if (!this->cartridge->hasBattery() || path == NULL)
+    {
+        return;
+    }
+
+    // The save file is the size of the RAM in the header, with the
+    // clock stored after it if there is one
+    int ramSize = this->cartridge->getRamSize();
+    int saveSize = ramSize + (this->cartridge->hasRtc() ? RTC_SAVE_SIZE : 0);
+    if (saveSize == 0)
+    {
+        return;
+    }
+
+    if (!this->saveFile.open(path, saveSize))
+    {
+        cout << "Unable to open save file " << path << endl;
+        return;
+    }
+
+    if (ramSize > 0)
+    {
+        this->ramBanks = this->saveFile.getData();
+        this->ramMask = ramSize - 1;
+        this->updatePageTable();
+    }
+
+    if (this->cartridge->hasRtc() && !this->saveFile.isNew())
+    {
+        this->rtc.load(this->saveFile.getData() + ramSize, this->core->clock);
+    }
+}
+
+void Mmu::setBatteryDataPrivate(bool isPrivate)
 {
-    return this->timerFrequencyChanged;
+    int ramSize = this->cartridge->getRamSize();
+    this->batteryDataPrivate = isPrivate && this->saveFile.isOpen();
+
+    if (!this->saveFile.isOpen() || ramSize == 0)
+    {
+        return;
+    }
+
+    if (isPrivate)
+    {
+        // The copy starts as the file is. The mask stays the file's size
+        memcpy(this->ramBuffer, this->saveFile.getData(), ramSize);
+        this->ramBanks = this->ramBuffer;
+    }
+    else
+    {
+        // Whatever was written to the copy is thrown away
+        this->ramBanks = this->saveFile.getData();
+    }
+
+    this->updatePageTable();
 }
 
-void Mmu::setTimerFrequencyChanged(bool val)
+void Mmu::flushBatteryData()
 {
-    this->timerFrequencyChanged = val;
+    // While private, the clock and RAM are from frames that won't be kept
+    if (!this->saveFile.isOpen() || this->batteryDataPrivate)
+    {
+        return;
+    }
+
+    // The clock isn't written as it runs, so store it now
+    if (this->cartridge->hasRtc())
+    {
+        this->rtc.save(this->saveFile.getData() + this->cartridge->getRamSize(), this->core->clock);
+        this->saveFile.markDirty();
+    }
+
+    this->saveFile.requestFlush();
 }
 
-void Mmu::increaseDividerRegister()
+void Mmu::closeBatteryData()
 {
-    // We need this special method to increase the divider register because if a game
-    // tries to write to this address directly, it will actually reset the value to 0
-    this->memory[DIVIDER_REGISTER_ADDR]++;
+    if (!this->saveFile.isOpen())
+    {
+        return;
+    }
+
+    if (this->cartridge->hasRtc())
+    {
+        this->rtc.save(this->saveFile.getData() + this->cartridge->getRamSize(), this->core->clock);
+        this->saveFile.markDirty();
+    }
+
+    this->saveFile.close();
+
+    this->ramBanks = this->ramBuffer;
+    this->ramMask = MAXIMUM_RAM_BANKS * RAM_BANK_SIZE - 1;
+    this->updatePageTable();
 }
 
 void Mmu::updateCurrentScanline()
 {
     // We need this special method to increase the current scanline
     // as the game should not be writing here directly
-    this->memory[CURRENT_SCANLINE_ADDR]++;
+    this->core->currentScanline++;
 }
 
 void Mmu::resetCurrentScanline()
 {
     // We need this special method to rest the current scanline
     // as the game should not be writing here directly
-    this->memory[CURRENT_SCANLINE_ADDR] = 0;
+    this->core->currentScanline = 0;
 }
 
 void Mmu::doDmaTransfer(Byte data)
@@ -348,8 +857,61 @@ void Mmu::doDmaTransfer(Byte data)
     // The source address for the sprite data is represented by
     // the data being "written" * 100
     Word address = data << 8; // This is the same as multiplying by 100
-    for (int i = 0; i < 160; i++)
+
+    this->notifyVideoMemoryWillChange(SPRITE_ATTRIBUTE_TABLE_ADDR);
+
+    // Nothing else can see OAM until the transfer is done, so we can copy
+    // it all at once. The source never crosses a page, so if the page can be
+    // read directly it is a single copy
+    const Byte *page = this->core->readPages[address >> 12];
+    if (page != NULL && !this->dmaActive)
     {
-        this->writeMemory(0xFE00 + i, this->readMemory(address + i));
+        memcpy(this->highMemory, page + (address & 0xFFF), OAM_SIZE);
+    }
+    else
+    {
+        this->dmaActive = false;
+        for (int i = 0; i < OAM_SIZE; i++)
+        {
+            this->highMemory[i] = this->readMemory(address + i);
+        }
     }
+
+    // The transfer takes 160 M-cycles on hardware, during which the CPU can
+    // only use HRAM, the I/O ports and whichever of the external bus or
+    // VRAM the transfer isn't reading from
+    this->dmaActive = true;
+    this->dmaFromVideoRam = address >= 0x8000 && address < 0xA000;
+    this->updatePageTable();
+
+    this->core->scheduler.schedule(EVENT_DMA_END, this->core->clock + DMA_CYCLES);
+}
+
+void Mmu::finishDmaTransfer()
+{
+    this->dmaActive = false;
+    this->updatePageTable();
+
+    if (this->videoObserver != NULL)
+    {
+        this->videoObserver->spritesChanged();
+    }
+}
+
+bool Mmu::isDmaBlocked(Word address)
+{
+    // OAM is always blocked, and the I/O ports and HRAM never are
+    if (address >= 0xFE00 && address < 0xFEA0)
+    {
+        return true;
+    }
+
+    if (address >= 0xFF00)
+    {
+        return false;
+    }
+
+    // Otherwise it depends on if the address is on the same bus as the source
+    bool inVideoRam = address >= 0x8000 && address < 0xA000;
+    return inVideoRam == this->dmaFromVideoRam;
 }
@@ -19,15 +19,28 @@
 #ifndef __MMU_H_INCLUDED__
 #define __MMU_H_INCLUDED__
 
+#include <memory>
+
+#include "apu.h"
+#include "cartridge.h"
+#include "core.h"
+#include "joypad.h"
+#include "rtc.h"
+#include "savestate.h"
+#include "savefile.h"
+#include "tilecache.h"
+#include "timer.h"
+#include "videoobserver.h"
+#include "videosync.h"
 #include "utils.h"
 
 class Mmu {
 
     public:
-        Mmu() {};
+        Mmu(Core *_core) : core(_core), timer(_core), apu(_core), joypad(_core) {};
 
-        // Load ROM data into memory
-        void loadRom(Byte *cartridge);
+        // Point the MMU at the (shared) cartridge image
+        void loadRom(std::shared_ptr<const Cartridge> cartridge);
 
         // Reset MMU to initial state
         void reset();
@@ -35,46 +48,135 @@ class Mmu {
         Byte readMemory(Word address);
         void writeMemory(Word address, Byte data);
 
-        bool isTimerFrequencyChanged();
-        void setTimerFrequencyChanged(bool val);
+        // The total cycles executed (kept in the core block). Anything that can
+        // be derived from time (i.e. the RTC) is computed from this on demand
+        unsigned long long getClock();
 
-        void increaseDividerRegister();
+        // Called when the DMA transfer event is due (see doDmaTransfer)
+        void finishDmaTransfer();
+
+        // Battery backed RAM (and the RTC) is kept in a memory-mapped save
+        // file. Closing it flushes everything to disk
+        void loadBatteryData(const char *path);
+        void closeBatteryData();
+
+        // While private, external RAM is a copy of the save file that is
+        // thrown away afterwards, and nothing is flushed to the file. This is
+        // for frames that are run ahead and then undone (see Gameboy::run),
+        // so the file only ever has RAM from frames that were kept
+        void setBatteryDataPrivate(bool isPrivate);
+
+        const Cartridge *getCartridge();
+        Rtc *getRtc();
+        Timer *getTimer();
+        Apu *getApu();
+        Joypad *getJoypad();
+
+        // Tell the observer (the display) about writes to video registers
+        void setVideoObserver(VideoObserver *observer);
+
+        // Have the PPU catch up before video registers and memory are used
+        void setVideoSync(VideoSync *sync);
+
+        // The LCD registers as the PPU sees them. readMemory is the CPU's
+        // view, which can't see them during DMA and has side effects
+        Byte getVideoRegister(Word address);
+
+        // The display reads VRAM directly rather than a byte at a time
+        const Byte *getVideoRam();
+
+        // OAM (the sprite attribute table)
+        const Byte *getOam();
+
+        // Tile data decoded from VRAM, kept up to date on VRAM writes
+        const TileCache *getTileCache();
+
+        // Memory, the banks selected, and the state of everything the MMU
+        // owns. The cartridge has to be the one the state was saved with
+        void saveState(StateWriter &state);
+        void loadState(StateReader &state);
 
         // These are convenicence functions for Scanline stuff
         void updateCurrentScanline();
         void resetCurrentScanline();
 
     private:
-        Byte *cartridge;
-        Byte memory[MEMORY_SIZE];
+        // The clock, interrupt registers, current scanline and
+        // the page table live in the core block (see core.h)
+        Core *core;
 
-        // Memory banking modes
-        bool mbc1 = false;
-        bool mbc2 = false;
+        std::shared_ptr<const Cartridge> cartridge;
+        const Byte *rom = NULL;
+        int romBankMask = 1;
+
+        // 0x0000 - 0x7FFF is read straight from the cartridge, and ECHO
+        // is read from work RAM, so only these regions need storage
+        Byte videoRam[VIDEO_RAM_SIZE];
+        Byte workRam[WORK_RAM_SIZE];
+        Byte highMemory[HIGH_MEMORY_SIZE];
+
+        TileCache tileCache;
+
+        VideoObserver *videoObserver = NULL;
+        void notifyPaletteChanged(Word address);
+        void notifyVideoMemoryWillChange(Word address);
+
+        VideoSync *videoSync = NULL;
+        bool isVideoAddress(Word address);
+        void syncVideo();
 
         // Current bank in switchable memory (0x4000 - 0x7FFF)
         // The default state will be 1
         int currentRomBank = 1;
 
         // Initialize data for RAM, using an array with the size
-        // times the maximum number of banks we have
-        int ramBanks[MAXIMUM_RAM_BANKS * RAM_BANK_SIZE];
+        // times the maximum number of banks we have. If the cartridge has
+        // a battery, ramBanks will point into the save file instead, which
+        // may be smaller, so accesses are masked to its size
+        Byte ramBuffer[MAXIMUM_RAM_BANKS * RAM_BANK_SIZE];
+        Byte *ramBanks = ramBuffer;
+        int ramMask = MAXIMUM_RAM_BANKS * RAM_BANK_SIZE - 1;
         int currentRamBank = 0;
 
+        SaveFile saveFile;
+        bool batteryDataPrivate = false;
+
         bool romBanking = true;
         bool enableRam = false;
 
+        // MBC3 has a real time clock which is latched by writing 0 then 1
+        // to 0x6000 - 0x7FFF, so we need the last value written there
+        Rtc rtc;
+        Byte lastLatchWrite = 0xFF;
+
+        // DIV, TIMA, TMA and TAC are worked out from the clock when read
+        Timer timer;
+
+        // The sound registers (0xFF10 - 0xFF3F) belong to the APU
+        Apu apu;
+
+        // P1 (0xFF00), and the buttons the host has pressed
+        Joypad joypad;
+
+        // Point the page table at the current banks
+        void updatePageTable();
+
         void handleBanking(Word address, Byte data);
         void doEnableRamBanking(Word address, Byte data);
         void doRomLoBankChange(Byte data);
         void doRomHiBankChange(Byte data);
         void doRamBankChange(Byte data);
         void doChangeRomRamMode(Byte data);
+        void doRtcLatch(Byte data);
+        void flushBatteryData();
 
-        // Temp flag for noting if timer controller updated
-        bool timerFrequencyChanged = false;
+        // While a DMA transfer is running the CPU can't use the bus it is
+        // copying from, or OAM
+        bool dmaActive = false;
+        bool dmaFromVideoRam = false;
 
         void doDmaTransfer(Byte data);
+        bool isDmaBlocked(Word address);
 };
 
 #endif
@@ -0,0 +1,383 @@
+#include <cstring>
+
+#include "pixelfifo.h"
+#include "utils.h"
+
+// How long the fetcher takes to fetch a tile (number, low byte, high byte)
+const int FETCH_CYCLES = 6;
+
+void PixelFifoRenderer::reset()
+{
+    this->done = false;
+    this->windowTriggered = false;
+    this->windowLine = 0;
+}
+
+void PixelFifoRenderer::finishFrame()
+{
+    // The window starts from its first line again each frame
+    this->windowTriggered = false;
+    this->windowLine = 0;
+}
+
+void PixelFifoRenderer::disable()
+{
+    this->reset();
+}
+
+void PixelFifoRenderer::saveState(StateWriter &state)
+{
+    // A state can be saved part way through a line, so everything the
+    // FIFOs and the fetcher are doing is in it
+    state.put(this->line);
+    state.put(this->x);
+    state.put(this->discard);
+    state.put(this->done);
+    state.write(this->backgroundFifo, sizeof(this->backgroundFifo));
+    state.put(this->backgroundHead);
+    state.put(this->backgroundCount);
+    state.write(this->spriteColors, sizeof(this->spriteColors));
+    state.write(this->spriteAttributes, sizeof(this->spriteAttributes));
+    state.put(this->fetcherCycles);
+    state.put(this->fetchX);
+    state.put(this->windowTriggered);
+    state.put(this->inWindow);
+    state.put(this->windowLine);
+
+    for (int i = 0; i < MAX_SPRITES_PER_LINE; i++)
+    {
+        state.put(this->sprites[i].y);
+        state.put(this->sprites[i].x);
+        state.put(this->sprites[i].tile);
+        state.put(this->sprites[i].attributes);
+    }
+
+    state.put(this->spriteCount);
+    state.put(this->nextSprite);
+    state.put(this->spriteStall);
+    state.put(this->lastPenaltyTile);
+}
+
+void PixelFifoRenderer::loadState(StateReader &state)
+{
+    state.get(this->line);
+    state.get(this->x);
+    state.get(this->discard);
+    state.get(this->done);
+    state.read(this->backgroundFifo, sizeof(this->backgroundFifo));
+    state.get(this->backgroundHead);
+    state.get(this->backgroundCount);
+    state.read(this->spriteColors, sizeof(this->spriteColors));
+    state.read(this->spriteAttributes, sizeof(this->spriteAttributes));
+    state.get(this->fetcherCycles);
+    state.get(this->fetchX);
+    state.get(this->windowTriggered);
+    state.get(this->inWindow);
+    state.get(this->windowLine);
+
+    for (int i = 0; i < MAX_SPRITES_PER_LINE; i++)
+    {
+        state.get(this->sprites[i].y);
+        state.get(this->sprites[i].x);
+        state.get(this->sprites[i].tile);
+        state.get(this->sprites[i].attributes);
+    }
+
+    state.get(this->spriteCount);
+    state.get(this->nextSprite);
+    state.get(this->spriteStall);
+    state.get(this->lastPenaltyTile);
+}
+
+void PixelFifoRenderer::startTransfer(int line)
+{
+    Byte lcdControl = this->mmu->getVideoRegister(LCD_CONTROL_ADDR);
+    Byte scrollX = this->mmu->getVideoRegister(SCROLL_X_ADDR);
+
+    this->line = line;
+    this->x = 0;
+    this->done = false;
+
+    // The first SCX % 8 pixels of the first tile are off the left of the screen
+    this->discard = scrollX % 8;
+
+    this->backgroundHead = 0;
+    this->backgroundCount = 0;
+    memset(this->spriteColors, 0, sizeof(this->spriteColors));
+
+    // The first fetch of the line is thrown away, so the first pixels are
+    // only ready after two fetches (and a dot to get going). With no
+    // scrolling, window or sprites that makes mode 3 172 cycles
+    this->fetcherCycles = -(FETCH_CYCLES + 1);
+    this->fetchX = 0;
+
+    // Once WY has matched LY in a frame, the window can be drawn on every
+    // line after it
+    if (isBitSet(lcdControl, 5) && this->mmu->getVideoRegister(WINDOW_Y_ADDR) == line)
+    {
+        this->windowTriggered = true;
+    }
+
+    this->inWindow = false;
+
+    this->findSprites();
+    this->nextSprite = 0;
+    this->spriteStall = 0;
+    this->lastPenaltyTile = -1;
+}
+
+int PixelFifoRenderer::transfer(int cycles)
+{
+    int used = 0;
+    while (used < cycles && !this->done)
+    {
+        this->step();
+        used++;
+    }
+
+    return used;
+}
+
+bool PixelFifoRenderer::isTransferDone()
+{
+    return this->done;
+}
+
+int PixelFifoRenderer::getTransferWait()
+{
+    // Every pixel left takes at least a dot. The CPU writing registers part
+    // way through the line makes the PPU catch up first, so it doesn't have
+    // to be run any sooner
+    return SCREEN_WIDTH - this->x;
+}
+
+void PixelFifoRenderer::findSprites()
+{
+    // OAM search (mode 2) picks the first 10 sprites in OAM that are on the
+    // line. Like the scanline renderer, they are fetched in order of X, and
+    // when two have the same X the first in OAM wins
+    const Byte *oam = this->mmu->getOam();
+    Byte lcdControl = this->mmu->getVideoRegister(LCD_CONTROL_ADDR);
+    int spriteHeight = isBitSet(lcdControl, 2) ? 16 : 8;
+
+    this->spriteCount = 0;
+    for (int sprite = 0; sprite < SPRITE_COUNT && this->spriteCount < MAX_SPRITES_PER_LINE; sprite++)
+    {
+        const Byte *entry = oam + sprite * 4;
+        int top = entry[0] - 16;
+        if (this->line < top || this->line >= top + spriteHeight)
+        {
+            continue;
+        }
+
+        Sprite found;
+        found.y = top;
+        found.x = entry[1] - 8;
+        found.tile = entry[2];
+        found.attributes = entry[3];
+
+        int i = this->spriteCount++;
+        while (i > 0 && this->sprites[i - 1].x > found.x)
+        {
+            this->sprites[i] = this->sprites[i - 1];
+            i--;
+        }
+
+        this->sprites[i] = found;
+    }
+}
+
+void PixelFifoRenderer::step()
+{
+    // While a sprite is being fetched nothing else happens. Once it has been
+    // fetched its pixels go into the sprite FIFO
+    if (this->spriteStall > 0)
+    {
+        if (--this->spriteStall == 0)
+        {
+            this->fetchSprite(this->sprites[this->nextSprite++]);
+        }
+
+        return;
+    }
+
+    Byte lcdControl = this->mmu->getVideoRegister(LCD_CONTROL_ADDR);
+
+    // The window starts when the pixel about to be drawn is at WX - 7. The
+    // background FIFO is cleared and the fetcher starts again from the
+    // first tile of the window
+    if (this->windowTriggered && !this->inWindow && this->discard == 0 && isBitSet(lcdControl, 5)
+        && this->x + 7 >= this->mmu->getVideoRegister(WINDOW_X_ADDR))
+    {
+        this->inWindow = true;
+        this->backgroundCount = 0;
+        this->fetcherCycles = 0;
+        this->fetchX = 0;
+    }
+
+    // The fetcher takes 6 dots to fetch a tile, then waits until the FIFO
+    // is empty to push it
+    if (this->fetcherCycles < FETCH_CYCLES)
+    {
+        this->fetcherCycles++;
+    }
+
+    if (this->fetcherCycles >= FETCH_CYCLES && this->backgroundCount == 0)
+    {
+        this->fetchTile();
+        this->fetcherCycles = 0;
+    }
+
+    if (this->backgroundCount == 0)
+    {
+        return;
+    }
+
+    // A sprite that starts at this pixel stops the pixels shifting out while
+    // it is fetched. It takes 6 dots, plus however long is left fetching
+    // the background tile under it for the first sprite on that tile
+    if (this->discard == 0 && isBitSet(lcdControl, 1) && this->nextSprite < this->spriteCount
+        && this->sprites[this->nextSprite].x <= this->x)
+    {
+        this->spriteStall = FETCH_CYCLES;
+
+        Byte scrollX = this->mmu->getVideoRegister(SCROLL_X_ADDR);
+        int tile = (this->x + scrollX) / 8;
+        if (tile != this->lastPenaltyTile)
+        {
+            int penalty = 5 - (this->x + scrollX) % 8;
+            this->spriteStall += penalty > 0 ? penalty : 0;
+            this->lastPenaltyTile = tile;
+        }
+
+        return;
+    }
+
+    Byte color = this->backgroundFifo[this->backgroundHead++];
+    this->backgroundCount--;
+
+    if (this->discard > 0)
+    {
+        this->discard--;
+        return;
+    }
+
+    this->outputPixel(color);
+}
+
+void PixelFifoRenderer::fetchTile()
+{
+    // Registers are read when the tile is fetched, not when the line starts
+    Byte lcdControl = this->mmu->getVideoRegister(LCD_CONTROL_ADDR);
+
+    Word mapAddress;
+    int column;
+    int yPos;
+
+    if (this->inWindow)
+    {
+        mapAddress = isBitSet(lcdControl, 6) ? 0x9C00 : 0x9800;
+        column = this->fetchX;
+        yPos = this->windowLine;
+    }
+    else
+    {
+        Byte scrollX = this->mmu->getVideoRegister(SCROLL_X_ADDR);
+        Byte scrollY = this->mmu->getVideoRegister(SCROLL_Y_ADDR);
+        mapAddress = isBitSet(lcdControl, 3) ? 0x9C00 : 0x9800;
+        column = (scrollX / 8 + this->fetchX) & 31;
+        yPos = (Byte) (scrollY + this->line);
+    }
+
+    this->fetchX++;
+    this->backgroundHead = 0;
+    this->backgroundCount = 8;
+
+    // When the background is turned off (bit 0) it is drawn as color 0
+    if (!isBitSet(lcdControl, 0))
+    {
+        memset(this->backgroundFifo, 0, sizeof(this->backgroundFifo));
+        return;
+    }
+
+    const Byte *tileMap = this->mmu->getVideoRam() + (mapAddress - VIDEO_RAM_START) + ((yPos / 8) & 31) * 32;
+    Byte tileIdentificationNumber = tileMap[column];
+
+    // The tile identification number might be signed (see Display::renderBackground)
+    int tile = isBitSet(lcdControl, 4) ? tileIdentificationNumber : 256 + (SignedByte) tileIdentificationNumber;
+    memcpy(this->backgroundFifo, this->mmu->getTileCache()->getLine(tile, yPos % 8), 8);
+}
+
+void PixelFifoRenderer::fetchSprite(const Sprite &sprite)
+{
+    Byte lcdControl = this->mmu->getVideoRegister(LCD_CONTROL_ADDR);
+    bool isTallSprite = isBitSet(lcdControl, 2);
+    int spriteHeight = isTallSprite ? 16 : 8;
+
+    int line = this->line - sprite.y;
+    if (isBitSet(sprite.attributes, 6))
+    {
+        line = spriteHeight - 1 - line;
+    }
+
+    int tile = isTallSprite ? (sprite.tile & 0xFE) + line / 8 : sprite.tile;
+    const Byte *spriteLine = this->mmu->getTileCache()->getLine(tile, line % 8);
+
+    // A sprite's pixels only go into slots no earlier sprite has filled, so
+    // the first sprite fetched wins where they overlap. Pixels already off
+    // the left of the screen (or already drawn) are dropped
+    for (int i = 0; i < 8; i++)
+    {
+        int slot = sprite.x + i - this->x;
+        if (slot < 0)
+        {
+            continue;
+        }
+
+        Byte color = spriteLine[isBitSet(sprite.attributes, 5) ? 7 - i : i];
+        if (color != 0 && this->spriteColors[slot] == 0)
+        {
+            this->spriteColors[slot] = color;
+            this->spriteAttributes[slot] = sprite.attributes;
+        }
+    }
+}
+
+void PixelFifoRenderer::outputPixel(Byte color)
+{
+    Byte lcdControl = this->mmu->getVideoRegister(LCD_CONTROL_ADDR);
+
+    // The palettes are read as the pixel is drawn, from the display's lookup
+    // tables which are rebuilt as soon as a palette is written
+    Byte spriteColor = this->spriteColors[0];
+    Byte spriteAttributes = this->spriteAttributes[0];
+
+    Byte shade;
+    if (spriteColor != 0 && isBitSet(lcdControl, 1) && !(isBitSet(spriteAttributes, 7) && color != 0))
+    {
+        shade = this->display->getPaletteShades(isBitSet(spriteAttributes, 4) ? 2 : 1)[spriteColor];
+    }
+    else
+    {
+        shade = this->display->getPaletteShades(0)[color];
+    }
+
+    this->display->getScreenLine(this->line)[this->x] = shade;
+
+    // Shift the sprite FIFO along with the pixel
+    memmove(this->spriteColors, this->spriteColors + 1, 7);
+    memmove(this->spriteAttributes, this->spriteAttributes + 1, 7);
+    this->spriteColors[7] = 0;
+
+    this->x++;
+    if (this->x == SCREEN_WIDTH)
+    {
+        this->done = true;
+
+        // The window line only moves on when the window was drawn
+        if (this->inWindow)
+        {
+            this->windowLine++;
+        }
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ *
+ * PIXEL FIFO RENDERER
+ * The accurate renderer for the PPU (see ppu.h). This works like the
+ * hardware does during mode 3, a dot (cycle) at a time:
+ *  - a fetcher reads the tile number and tile data for the next 8 pixels
+ *    of the background (or window), which takes 6 dots, and pushes them into
+ *    the background FIFO once it is empty
+ *  - each dot, a pixel is shifted out of the FIFO onto the screen, mixed with
+ *    the sprite FIFO
+ *  - the first SCX % 8 pixels are thrown away, which makes mode 3 longer
+ *  - when the window starts, the FIFO is cleared and the fetcher starts again
+ *    from the window, which makes mode 3 longer
+ *  - when a sprite starts at the current pixel, shifting stops while it is
+ *    fetched (6 - 11 dots) and its pixels go into the sprite FIFO
+ *
+ * Registers are read as they are needed rather than once a line, so games
+ * that change scroll, palettes or LCDC part way through a line show up as
+ * they would on hardware
+ *
+ **/
+
+#ifndef __PIXELFIFO_H_INCLUDED__
+#define __PIXELFIFO_H_INCLUDED__
+
+#include "display.h"
+#include "mmu.h"
+#include "savestate.h"
+#include "utils.h"
+
+class PixelFifoRenderer {
+
+    public:
+        static const Word STATE_ID = SAVE_STATE_RENDERER_PIXEL_FIFO;
+
+        PixelFifoRenderer(Mmu *_mmu, Display *_display) : mmu(_mmu), display(_display) {};
+
+        void reset();
+        void startTransfer(int line);
+        int transfer(int cycles);
+        bool isTransferDone();
+        int getTransferWait();
+        void finishFrame();
+        void disable();
+
+        void saveState(StateWriter &state);
+        void loadState(StateReader &state);
+
+    private:
+        Mmu *mmu;
+        Display *display;
+
+        int line = 0;
+
+        // The next pixel to put on the screen, and how many pixels still
+        // need to be thrown away for fine scrolling
+        int x = 0;
+        int discard = 0;
+        bool done = false;
+
+        // The background FIFO (color indices)
+        Byte backgroundFifo[8];
+        int backgroundHead = 0;
+        int backgroundCount = 0;
+
+        // The sprite FIFO lines up with the next 8 pixels. Color 0 is empty
+        Byte spriteColors[8];
+        Byte spriteAttributes[8];
+
+        // The fetcher counts up to 6 dots per tile, and fetchX is the
+        // number of tiles fetched across the line
+        int fetcherCycles = 0;
+        int fetchX = 0;
+
+        // The window starts once WY matches LY in a frame, and has its own
+        // line counter which only moves on lines where it was drawn
+        bool windowTriggered = false;
+        bool inWindow = false;
+        int windowLine = 0;
+
+        // Sprites on this line (at most 10) by X, and the one to fetch next
+        Sprite sprites[MAX_SPRITES_PER_LINE];
+        int spriteCount = 0;
+        int nextSprite = 0;
+        int spriteStall = 0;
+        int lastPenaltyTile = -1;
+
+        void step();
+        void fetchTile();
+        void findSprites();
+        void fetchSprite(const Sprite &sprite);
+        void outputPixel(Byte color);
+};
+
+#endif
@@ -0,0 +1,193 @@
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PIXEL_OPS_X86
+#endif
+
+#include "pixelops.h"
+#include "utils.h"
+
+/* -------------------------Scalar--------------------------- */
+
+static void decodeTileLinesScalar(const Byte *tileData, Byte *colors, int lines)
+{
+    // The two bytes of a line combine like the following example:
+    //
+    // Pixel #:   0  1  2  3  4  5  6  7
+    // data2 bit: 1  0  1  0  1  1  1  0
+    // data1 bit: 0  0  1  1  0  1  0  1
+    //
+    // Pixel 0 colour id: 10
+    // Pixel 1 colour id: 00
+    // ...
+    for (int line = 0; line < lines; line++)
+    {
+        Byte data1 = tileData[line * 2];
+        Byte data2 = tileData[line * 2 + 1];
+
+        for (int pixel = 0; pixel < 8; pixel++)
+        {
+            int colorBit = 7 - pixel;
+            colors[line * 8 + pixel] = (getBitVal(data2, colorBit) << 1) | getBitVal(data1, colorBit);
+        }
+    }
+}
+
+static void mapPaletteScalar(const Byte *colors, Byte *shades, int count, const Byte *palette)
+{
+    for (int i = 0; i < count; i++)
+    {
+        shades[i] = palette[colors[i] & 3];
+    }
+}
+
+static void flipLineScalar(const Byte *colors, Byte *flipped)
+{
+    for (int pixel = 0; pixel < 8; pixel++)
+    {
+        flipped[pixel] = colors[7 - pixel];
+    }
+}
+
+static const PixelOps SCALAR_OPS = {
+    "scalar", decodeTileLinesScalar, mapPaletteScalar, flipLineScalar
+};
+
+#ifdef PIXEL_OPS_X86
+
+// Flipping a line is reversing 8 bytes, which is a single byte swap
+// whichever instruction set we have
+static void flipLineSwap(const Byte *colors, Byte *flipped)
+{
+    unsigned long long line;
+    memcpy(&line, colors, 8);
+    line = __builtin_bswap64(line);
+    memcpy(flipped, &line, 8);
+}
+
+// Broadcasting a byte to all 8 bytes of a 64 bit value
+static const unsigned long long BROADCAST = 0x0101010101010101ULL;
+
+// The bit of the data bytes for each pixel of a line, pixel 0 being bit 7
+static const unsigned long long PIXEL_BITS = 0x0102040810204080ULL;
+
+/* -------------------------SSE2--------------------------- */
+
+// SSE2 is always there on x86-64, but not on 32 bit x86
+__attribute__((target("sse2")))
+static void decodeTileLinesSse2(const Byte *tileData, Byte *colors, int lines)
+{
+    // Two lines at a time. Each data byte is copied to all 8 pixels of its
+    // line, then each pixel picks out its bit by comparing against a mask
+    const __m128i bits = _mm_set1_epi64x((long long) PIXEL_BITS);
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi8(2);
+
+    int line = 0;
+    for (; line + 2 <= lines; line += 2)
+    {
+        const Byte *data = tileData + line * 2;
+        __m128i data1 = _mm_set_epi64x((long long) (data[2] * BROADCAST), (long long) (data[0] * BROADCAST));
+        __m128i data2 = _mm_set_epi64x((long long) (data[3] * BROADCAST), (long long) (data[1] * BROADCAST));
+
+        __m128i lo = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(data1, bits), bits), one);
+        __m128i hi = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(data2, bits), bits), two);
+        _mm_storeu_si128((__m128i *) (colors + line * 8), _mm_or_si128(lo, hi));
+    }
+
+    decodeTileLinesScalar(tileData + line * 2, colors + line * 8, lines - line);
+}
+
+// Without a byte shuffle, palette mapping is 4 compares and selects per 16
+// pixels, which is slower than the scalar lookup in the Makefile's build (see
+// make check), so the scalar one is used
+static const PixelOps SSE2_OPS = {
+    "sse2", decodeTileLinesSse2, mapPaletteScalar, flipLineSwap
+};
+
+/* -------------------------AVX2--------------------------- */
+
+__attribute__((target("avx2")))
+static void decodeTileLinesAvx2(const Byte *tileData, Byte *colors, int lines)
+{
+    // Same as SSE2, four lines at a time
+    const __m256i bits = _mm256_set1_epi64x((long long) PIXEL_BITS);
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i two = _mm256_set1_epi8(2);
+
+    int line = 0;
+    for (; line + 4 <= lines; line += 4)
+    {
+        const Byte *data = tileData + line * 2;
+        __m256i data1 = _mm256_set_epi64x((long long) (data[6] * BROADCAST), (long long) (data[4] * BROADCAST), (long long) (data[2] * BROADCAST), (long long) (data[0] * BROADCAST));
+        __m256i data2 = _mm256_set_epi64x((long long) (data[7] * BROADCAST), (long long) (data[5] * BROADCAST), (long long) (data[3] * BROADCAST), (long long) (data[1] * BROADCAST));
+
+        __m256i lo = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(data1, bits), bits), one);
+        __m256i hi = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(data2, bits), bits), two);
+        _mm256_storeu_si256((__m256i *) (colors + line * 8), _mm256_or_si256(lo, hi));
+    }
+
+    decodeTileLinesSse2(tileData + line * 2, colors + line * 8, lines - line);
+}
+
+__attribute__((target("avx2")))
+static void mapPaletteAvx2(const Byte *colors, Byte *shades, int count, const Byte *palette)
+{
+    // The palette fits in the first 4 bytes of a shuffle table, so each
+    // color index selects its shade directly
+    const __m256i table = _mm256_setr_epi8(
+        palette[0], palette[1], palette[2], palette[3], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        palette[0], palette[1], palette[2], palette[3], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask = _mm256_set1_epi8(3);
+
+    int i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i c = _mm256_and_si256(_mm256_loadu_si256((const __m256i *) (colors + i)), mask);
+        _mm256_storeu_si256((__m256i *) (shades + i), _mm256_shuffle_epi8(table, c));
+    }
+
+    mapPaletteScalar(colors + i, shades + i, count - i, palette);
+}
+
+static const PixelOps AVX2_OPS = {
+    "avx2", decodeTileLinesAvx2, mapPaletteAvx2, flipLineSwap
+};
+
+#endif
+
+/* -------------------------Selection--------------------------- */
+
+std::vector<const PixelOps *> getSupportedPixelOps()
+{
+    std::vector<const PixelOps *> supported = { &SCALAR_OPS };
+
+#ifdef PIXEL_OPS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+    {
+        supported.push_back(&SSE2_OPS);
+    }
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        supported.push_back(&AVX2_OPS);
+    }
+#endif
+
+    return supported;
+}
+
+const PixelOps *getPixelOps()
+{
+    // Each set is at least as fast as the one before it in every operation,
+    // so the last is the best (see make check)
+    static const PixelOps *ops = getSupportedPixelOps().back();
+    return ops;
+}
+
+const PixelOps *getScalarPixelOps()
+{
+    return &SCALAR_OPS;
+}
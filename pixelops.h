@@ -0,0 +1,46 @@
+/**
+ *
+ * PIXEL OPERATIONS
+ * The inner loops of drawing are pure bit manipulation:
+ *  - decoding tile lines, where the two bitplane bytes of a line are combined
+ *    into 8 color indices (0 - 3)
+ *  - mapping color indices through a palette (BGP/OBP0/OBP1) into shades
+ *  - flipping a tile line for sprites with X flip
+ *
+ * Each has a plain version, and x86 CPUs get SSE2 or AVX2 versions, picked
+ * when the program starts based on what the CPU supports. Every version has to
+ * give exactly what the plain one does - pixelops_test (make check) runs each
+ * of them over every possible input and times them
+ *
+ **/
+
+#ifndef __PIXELOPS_H_INCLUDED__
+#define __PIXELOPS_H_INCLUDED__
+
+#include <vector>
+
+#include "utils.h"
+
+struct PixelOps {
+    const char *name;
+
+    // Decode lines of tile data (2 bytes each) into 8 color indices each
+    void (*decodeTileLines)(const Byte *tileData, Byte *colors, int lines);
+
+    // Map count color indices into shades using a 4 entry palette
+    void (*mapPalette)(const Byte *colors, Byte *shades, int count, const Byte *palette);
+
+    // Reverse the 8 pixels of a tile line
+    void (*flipLine)(const Byte *colors, Byte *flipped);
+};
+
+// The best operations this CPU supports
+const PixelOps *getPixelOps();
+
+// Every version this CPU can run, the plain one first and the best last
+std::vector<const PixelOps *> getSupportedPixelOps();
+
+// The plain operations, which everything else has to match
+const PixelOps *getScalarPixelOps();
+
+#endif
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+#include "pixelops.h"
+#include "utils.h"
+
+using namespace std;
+
+// Every possible pair of bytes is one tile line
+static const int LINES = 0x10000;
+
+// How many times each operation is run over all of it when timing
+static const int ROUNDS = 20;
+
+// The 4 shades of each of the 256 palette register values
+static void getPalette(int value, Byte *palette)
+{
+    for (int color = 0; color < 4; color++)
+    {
+        palette[color] = (value >> (color * 2)) & 3;
+    }
+}
+
+// Check ops against the scalar operations over every tile line, every
+// palette and the flip of every line. Prints the first difference found
+static bool check(const PixelOps *ops, const PixelOps *scalar, const vector<Byte> &tileData)
+{
+    vector<Byte> expected(LINES * 8);
+    vector<Byte> actual(LINES * 8);
+
+    // Decoding. Also as odd lengths, so the leftovers after the vectors are
+    // checked too
+    scalar->decodeTileLines(tileData.data(), expected.data(), LINES);
+    for (int lines = 1; lines <= 9; lines += 2)
+    {
+        ops->decodeTileLines(tileData.data(), actual.data(), lines);
+        if (memcmp(expected.data(), actual.data(), lines * 8) != 0)
+        {
+            printf("%s: decoding %d lines doesn't match scalar\n", ops->name, lines);
+            return false;
+        }
+    }
+
+    ops->decodeTileLines(tileData.data(), actual.data(), LINES);
+    for (int line = 0; line < LINES; line++)
+    {
+        if (memcmp(&expected[line * 8], &actual[line * 8], 8) != 0)
+        {
+            printf("%s: decoding %02X %02X doesn't match scalar\n", ops->name, tileData[line * 2], tileData[line * 2 + 1]);
+            return false;
+        }
+    }
+
+    // Palette mapping, of every decoded line through every palette. The
+    // count is odd for the same reason as above
+    const vector<Byte> &colors = expected;
+    vector<Byte> expectedShades(LINES * 8);
+    vector<Byte> actualShades(LINES * 8);
+    for (int value = 0; value < 256; value++)
+    {
+        Byte palette[4];
+        getPalette(value, palette);
+
+        int count = LINES * 8 - (value & 31);
+        scalar->mapPalette(colors.data(), expectedShades.data(), count, palette);
+        ops->mapPalette(colors.data(), actualShades.data(), count, palette);
+        if (memcmp(expectedShades.data(), actualShades.data(), count) != 0)
+        {
+            printf("%s: mapping through palette %02X doesn't match scalar\n", ops->name, value);
+            return false;
+        }
+    }
+
+    // X flip of every decoded line
+    for (int line = 0; line < LINES; line++)
+    {
+        scalar->flipLine(&colors[line * 8], &expectedShades[0]);
+        ops->flipLine(&colors[line * 8], &actualShades[0]);
+        if (memcmp(expectedShades.data(), actualShades.data(), 8) != 0)
+        {
+            printf("%s: flipping %02X %02X doesn't match scalar\n", ops->name, tileData[line * 2], tileData[line * 2 + 1]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Nanoseconds per pixel for each operation, over every tile line
+static void bench(const PixelOps *ops, const vector<Byte> &tileData)
+{
+    vector<Byte> colors(LINES * 8);
+    vector<Byte> shades(LINES * 8);
+    Byte palette[4] = { 0, 1, 2, 3 };
+    const double pixels = (double) LINES * 8 * ROUNDS;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        ops->decodeTileLines(tileData.data(), colors.data(), LINES);
+    }
+    chrono::steady_clock::time_point decoded = chrono::steady_clock::now();
+
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        // A different palette each time, so nothing is hoisted out
+        palette[round & 3] = round & 3;
+        ops->mapPalette(colors.data(), shades.data(), LINES * 8, palette);
+    }
+    chrono::steady_clock::time_point mapped = chrono::steady_clock::now();
+
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (int line = 0; line < LINES; line++)
+        {
+            ops->flipLine(&colors[line * 8], &shades[line * 8]);
+        }
+    }
+    chrono::steady_clock::time_point flipped = chrono::steady_clock::now();
+
+    // Use the output, so none of it is left out
+    unsigned int sum = 0;
+    for (int i = 0; i < LINES * 8; i++)
+    {
+        sum += shades[i];
+    }
+
+    printf("%-8s decode %6.3f  palette %6.3f  flip %6.3f ns/pixel  (%u)\n", ops->name,
+        chrono::duration<double, nano>(decoded - start).count() / pixels,
+        chrono::duration<double, nano>(mapped - decoded).count() / pixels,
+        chrono::duration<double, nano>(flipped - mapped).count() / pixels,
+        sum);
+}
+
+// Checks every version of the pixel operations this CPU can run against
+// the scalar ones, then times them. Returns 1 if any don't match
+int main()
+{
+    vector<Byte> tileData(LINES * 2);
+    for (int line = 0; line < LINES; line++)
+    {
+        tileData[line * 2] = line & 0xFF;
+        tileData[line * 2 + 1] = line >> 8;
+    }
+
+    const PixelOps *scalar = getScalarPixelOps();
+    vector<const PixelOps *> supported = getSupportedPixelOps();
+
+    bool matched = true;
+    for (const PixelOps *ops : supported)
+    {
+        if (ops != scalar && !check(ops, scalar, tileData))
+        {
+            matched = false;
+        }
+    }
+
+    for (const PixelOps *ops : supported)
+    {
+        bench(ops, tileData);
+    }
+
+    printf("Using %s\n", getPixelOps()->name);
+
+    if (!matched)
+    {
+        return 1;
+    }
+
+    printf("All %d versions match scalar\n", (int) supported.size());
+    return 0;
+}
@@ -0,0 +1,272 @@
+#include "pixelfifo.h"
+#include "ppu.h"
+#include "scanline.h"
+#include "utils.h"
+
+template <class Renderer>
+void Ppu<Renderer>::reset()
+{
+    this->core->lineStart = this->core->clock;
+    this->core->transferCycles = 0;
+    this->core->lcdMode = 2;
+    this->core->lcdEnabled = false;
+    this->core->statLine = false;
+    this->renderer.reset();
+
+    // The LCD is turned on (or not) when the first event is handled
+    this->core->scheduler.schedule(EVENT_PPU, this->core->clock);
+}
+
+template <class Renderer>
+bool Ppu<Renderer>::isLcdEnabled()
+{
+    Byte lcdControl = this->mmu->getVideoRegister(LCD_CONTROL_ADDR);
+    return isBitSet(lcdControl, 7); // Bit 7 specified is LCD is enabled
+}
+
+template <class Renderer>
+void Ppu<Renderer>::update()
+{
+    this->running = true;
+
+    if (!this->isLcdEnabled())
+    {
+        // If the LCD is disabled we start again from the top once it
+        // is turned back on. Nothing happens until then, so there is
+        // nothing to schedule
+        if (this->core->lcdEnabled)
+        {
+            this->renderer.disable();
+            this->core->lcdEnabled = false;
+        }
+
+        // While the LCD is off, the status says V-Blank (mode 1)
+        this->core->lcdMode = 1;
+        this->core->statLine = false;
+        this->mmu->resetCurrentScanline();
+        this->core->scheduler.cancel(EVENT_PPU);
+        this->running = false;
+        return;
+    }
+
+    if (!this->core->lcdEnabled)
+    {
+        // The LCD has just been turned on, so line 0 starts now
+        this->core->lcdEnabled = true;
+        this->core->lineStart = this->core->clock;
+        this->mmu->resetCurrentScanline();
+        this->setMode(2);
+    }
+
+    unsigned long long boundary = this->runModes();
+
+    // STAT or LYC might have been written, which can raise the STAT line
+    this->updateStatLine();
+
+    this->core->scheduler.schedule(EVENT_PPU, this->findNextInterrupt(boundary));
+    this->running = false;
+}
+
+template <class Renderer>
+void Ppu<Renderer>::catchUp()
+{
+    if (this->core->lcdEnabled && !this->running)
+    {
+        this->running = true;
+        this->runModes();
+        this->running = false;
+    }
+}
+
+template <class Renderer>
+unsigned long long Ppu<Renderer>::runModes()
+{
+    // Go through every mode change up to now, returning when the next one is
+    while (true)
+    {
+        unsigned long long lineCycles = this->core->clock - this->core->lineStart;
+
+        switch (this->core->lcdMode)
+        {
+            case 2:
+                // Mode 2 (Searching Sprite Atts) is always 80 cycles
+                if (lineCycles < OAM_SEARCH_CYCLES)
+                {
+                    return this->core->lineStart + OAM_SEARCH_CYCLES;
+                }
+
+                this->setMode(3);
+                this->renderer.startTransfer(this->core->currentScanline);
+                break;
+
+            case 3:
+            {
+                // Mode 3 lasts as long as the renderer takes
+                int cycles = lineCycles - OAM_SEARCH_CYCLES - this->core->transferCycles;
+                this->core->transferCycles += this->renderer.transfer(cycles);
+                if (!this->renderer.isTransferDone())
+                {
+                    return this->core->lineStart + OAM_SEARCH_CYCLES + this->core->transferCycles + this->renderer.getTransferWait();
+                }
+
+                this->setMode(0);
+                break;
+            }
+
+            default:
+                // H-Blank and each line of V-Blank last until the end of the line
+                if (lineCycles < SCANLINE_CYCLES)
+                {
+                    return this->core->lineStart + SCANLINE_CYCLES;
+                }
+
+                this->nextLine();
+                break;
+        }
+    }
+}
+
+template <class Renderer>
+unsigned long long Ppu<Renderer>::findNextInterrupt(unsigned long long boundary)
+{
+    // Walk forward through the mode boundaries (starting with the next one)
+    // without doing anything, to find the first that requests an interrupt.
+    // There is always a V-Blank within a frame. How long mode 3 takes isn't
+    // known until it is run, so this uses the shortest it could be. If that
+    // is too early, the next catch up looks again
+    Byte mode = this->core->lcdMode;
+    Byte currentScanline = this->core->currentScanline;
+    unsigned long long lineStart = this->core->lineStart;
+    bool statLine = this->core->statLine;
+
+    unsigned long long time = boundary;
+    while (true)
+    {
+        switch (mode)
+        {
+            case 2: mode = 3; break;
+            case 3: mode = 0; break;
+            default:
+                lineStart += SCANLINE_CYCLES;
+                currentScanline++;
+                if (currentScanline == 144)
+                {
+                    return time;
+                }
+
+                if (currentScanline > MAX_SCANLINES)
+                {
+                    currentScanline = 0;
+                }
+
+                mode = currentScanline < 144 ? 2 : 1;
+                break;
+        }
+
+        bool line = this->isStatLineHigh(mode, currentScanline);
+        if (line && !statLine)
+        {
+            return time;
+        }
+
+        statLine = line;
+
+        switch (mode)
+        {
+            case 2: time = lineStart + OAM_SEARCH_CYCLES; break;
+            case 3: time = lineStart + OAM_SEARCH_CYCLES + TRANSFER_CYCLES; break;
+            default: time = lineStart + SCANLINE_CYCLES; break;
+        }
+    }
+}
+
+template <class Renderer>
+void Ppu<Renderer>::nextLine()
+{
+    this->core->lineStart += SCANLINE_CYCLES;
+    this->mmu->updateCurrentScanline();
+
+    Byte currentScanline = this->core->currentScanline;
+    if (currentScanline == 144)
+    {
+        // There are 144 visible scanlines (i.e. scanlines 0 - 143)
+        // If we are moving past that scanline, we are not drawing as
+        // it is an invisible scanline. This is the vertical blank period
+        // and we need an interrupt to handle it (which is bit 0 of the)
+        // the interrupt request register
+        this->cpu->requestInterrupt(0);
+        this->setMode(1);
+        this->renderer.finishFrame();
+    }
+    else if (currentScanline > MAX_SCANLINES)
+    {
+        // We have gone past the range of scanlines in this case, meaning we
+        // need to reset back to 0
+        this->mmu->resetCurrentScanline();
+        this->setMode(2);
+    }
+    else if (currentScanline < 144)
+    {
+        this->setMode(2);
+    }
+    else
+    {
+        // Still in V-Blank, but LY has changed
+        this->updateStatLine();
+    }
+}
+
+template <class Renderer>
+void Ppu<Renderer>::setMode(Byte mode)
+{
+    this->core->lcdMode = mode;
+    this->core->transferCycles = 0;
+    this->updateStatLine();
+}
+
+template <class Renderer>
+bool Ppu<Renderer>::isStatLineHigh(Byte mode, Byte currentScanline)
+{
+    // The interrupt line is high if any of the enabled sources are true:
+    //  Bit 6: LY is the same as LYC (0xFF45)
+    //  Bit 5: Mode 2
+    //  Bit 4: Mode 1
+    //  Bit 3: Mode 0
+    Byte lcdStatus = this->mmu->getVideoRegister(LCD_STATUS_ADDR);
+    if (isBitSet(lcdStatus, 6) && currentScanline == this->mmu->getVideoRegister(LYC_ADDR))
+    {
+        return true;
+    }
+
+    return mode != 3 && isBitSet(lcdStatus, 3 + mode);
+}
+
+template <class Renderer>
+void Ppu<Renderer>::updateStatLine()
+{
+    bool line = this->isStatLineHigh(this->core->lcdMode, this->core->currentScanline);
+
+    // Only going from low to high requests an LCD interrupt (bit 1)
+    if (line && !this->core->statLine)
+    {
+        this->cpu->requestInterrupt(1);
+    }
+
+    this->core->statLine = line;
+}
+
+template <class Renderer>
+void Ppu<Renderer>::saveState(StateWriter &state)
+{
+    this->renderer.saveState(state);
+}
+
+template <class Renderer>
+void Ppu<Renderer>::loadState(StateReader &state)
+{
+    this->renderer.loadState(state);
+}
+
+// The renderers the PPU can be used with
+template class Ppu<ScanlineRenderer>;
+template class Ppu<PixelFifoRenderer>;
@@ -0,0 +1,109 @@
+/**
+ *
+ * PPU TIMING
+ * Each scanline takes 456 cycles. It starts in mode 2 (searching OAM) for 80
+ * cycles, then mode 3 (transferring pixels to the LCD) and H-Blank (mode 0)
+ * for the rest of the line. After the 144 visible lines there are 10 lines of
+ * V-Blank (mode 1).
+ *
+ * The PPU doesn't run alongside the CPU. It catches up to the current cycle
+ * in one go, going through every boundary it has passed, when:
+ *  - the CPU reads or writes something the PPU uses or changes (the LCD
+ *    registers, VRAM or OAM), which the MMU tells us about (see videosync.h).
+ *    Between those, nothing the PPU reads can change, so lines can be drawn
+ *    in a batch long after they were due
+ *  - it is time for something the CPU sees without asking - the V-Blank
+ *    interrupt, or an LCD STAT interrupt. The next one of these is worked
+ *    out after each catch up and scheduled as an event (see scheduler.h)
+ * LY and the mode are only changed while catching up, and the STAT register
+ * is made up from them when it is read.
+ *
+ * The LCD STAT interrupt is requested when any of its enabled sources (LYC
+ * coincidence or the mode 0, 1 or 2 bits) becomes true while none of the
+ * others were, like the single interrupt line on hardware. While a source
+ * stays true (i.e. the rest of a line where LY matches LYC) nothing more is
+ * requested ("STAT blocking")
+ *
+ * How the pixels are made during mode 3, and so how long mode 3 lasts, is up
+ * to the renderer. It is a template parameter (a policy) so the timing is
+ * compiled for each renderer and neither pays for the other:
+ *  - ScanlineRenderer (scanline.h) draws whole lines. Fast, mode 3 is always
+ *    172 cycles
+ *  - PixelFifoRenderer (pixelfifo.h) runs the pixel FIFO a dot at a time, so
+ *    mid-line register changes show up and mode 3 is longer with scrolling,
+ *    the window and sprites, like on hardware
+ *
+ * A renderer has:
+ *  static const Word STATE_ID    - which renderer a state file is for
+ *  Renderer(Mmu *mmu, Display *display)
+ *  void reset()
+ *  void startTransfer(int line)  - mode 3 is starting on line
+ *  int transfer(int cycles)      - run mode 3 for up to cycles, returning how
+ *                                  many were used (fewer if it finished)
+ *  bool isTransferDone()
+ *  int getTransferWait()         - the least time left in mode 3, if it
+ *                                  isn't done
+ *  void finishFrame()            - V-Blank started
+ *  void disable()                - the LCD was turned off
+ *  void saveState(StateWriter &) - where it is in mode 3 (see savestate.h)
+ *  void loadState(StateReader &)
+ *
+ **/
+
+#ifndef __PPU_H_INCLUDED__
+#define __PPU_H_INCLUDED__
+
+#include "core.h"
+#include "cpu.h"
+#include "display.h"
+#include "mmu.h"
+#include "savestate.h"
+#include "videosync.h"
+#include "utils.h"
+
+template <class Renderer>
+class Ppu : public VideoSync {
+
+    public:
+        Ppu(Core *_core, Mmu *_mmu, Cpu *_cpu, Display *_display) : core(_core), mmu(_mmu), cpu(_cpu), renderer(_mmu, _display)
+        {
+            this->mmu->setVideoSync(this);
+        };
+
+        void reset();
+
+        // Handle everything up to the current clock, and schedule the next
+        // time the CPU has to see something. Called for EVENT_PPU
+        void update();
+
+        // Only run the modes up to now. The next interrupt can't have changed
+        // unless LCDC, STAT or LYC were written, which schedules an update
+        void catchUp();
+
+        // The line and mode are in the core block, so this is only what
+        // the renderer is doing
+        void saveState(StateWriter &state);
+        void loadState(StateReader &state);
+
+    private:
+        // The current line, mode and when the line started are in the core block
+        Core *core;
+        Mmu *mmu;
+        Cpu *cpu;
+
+        Renderer renderer;
+
+        // The PPU reads its registers through the MMU, which would ask it to
+        // catch up again while it is already running
+        bool running = false;
+
+        bool isLcdEnabled();
+        unsigned long long runModes();
+        unsigned long long findNextInterrupt(unsigned long long boundary);
+        void setMode(Byte mode);
+        void nextLine();
+        bool isStatLineHigh(Byte mode, Byte currentScanline);
+        void updateStatLine();
+};
+
+#endif
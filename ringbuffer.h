@@ -0,0 +1,102 @@
+/**
+ *
+ * RING BUFFER
+ * A fixed size queue between exactly one producer thread and one consumer
+ * thread (i.e. the emulator making audio samples and the SDL audio callback
+ * playing them). Neither side ever takes a lock or waits for the other - the
+ * producer drops what doesn't fit and the consumer takes what is there.
+ *
+ * Each side only writes its own index, and publishes it with a release store
+ * after touching the items, so the other side sees the items once it sees the
+ * index. The two indexes are on separate cache lines so the threads aren't
+ * fighting over one. The indexes only ever go up, and are masked to the
+ * capacity (a power of two) to find the item
+ *
+ **/
+
+#ifndef __RINGBUFFER_H_INCLUDED__
+#define __RINGBUFFER_H_INCLUDED__
+
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+
+#include "utils.h"
+
+template <class T>
+class RingBuffer {
+
+    public:
+        // The capacity must be a power of two
+        RingBuffer(size_t capacity) : mask(capacity - 1), items(new T[capacity]) {};
+
+        RingBuffer(const RingBuffer &) = delete;
+        RingBuffer &operator=(const RingBuffer &) = delete;
+
+        // Producer only. Returns false (and drops the item) if it is full
+        bool push(const T &item)
+        {
+            size_t write = this->writeIndex.load(std::memory_order_relaxed);
+            if (write - this->readIndex.load(std::memory_order_acquire) > this->mask)
+            {
+                return false;
+            }
+
+            this->items[write & this->mask] = item;
+            this->writeIndex.store(write + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only. Takes up to count items, returning how many it took
+        size_t pop(T *out, size_t count)
+        {
+            size_t read = this->readIndex.load(std::memory_order_relaxed);
+            size_t available = this->writeIndex.load(std::memory_order_acquire) - read;
+            if (count > available)
+            {
+                count = available;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                out[i] = this->items[(read + i) & this->mask];
+            }
+
+            this->readIndex.store(read + count, std::memory_order_release);
+            return count;
+        }
+
+        // Consumer only. Copies the next item without taking it, returning
+        // false if there isn't one
+        bool peek(T &out) const
+        {
+            size_t read = this->readIndex.load(std::memory_order_relaxed);
+            if (this->writeIndex.load(std::memory_order_acquire) == read)
+            {
+                return false;
+            }
+
+            out = this->items[read & this->mask];
+            return true;
+        }
+
+        // How many items are waiting. Only exact from the consumer's side
+        size_t size() const
+        {
+            return this->writeIndex.load(std::memory_order_acquire) - this->readIndex.load(std::memory_order_acquire);
+        }
+
+        size_t capacity() const
+        {
+            return this->mask + 1;
+        }
+
+    private:
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> writeIndex{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> readIndex{0};
+
+        alignas(CACHE_LINE_SIZE) size_t mask;
+        std::unique_ptr<T[]> items;
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <cstring>
+#include <ctime>
+
+#include "rtc.h"
+#include "utils.h"
+
+void Rtc::reset()
+{
+    this->baseSeconds = 0;
+    this->baseCycles = 0;
+    this->baseHostTime = time(NULL);
+
+    this->halted = false;
+    this->dayCarry = false;
+
+    memset(this->latched, 0, sizeof(this->latched));
+}
+
+void Rtc::setUseHostTime(bool val)
+{
+    // This should be configured before the game starts running, as the
+    // clock is not rebased when switching between sources
+    this->useHostTime = val;
+    this->baseHostTime = time(NULL);
+}
+
+void Rtc::fastForward(long long seconds)
+{
+    // Because the clock is only ever derived when latched, moving it
+    // forward any amount of time is just moving the base
+    this->baseSeconds += seconds;
+}
+
+long long Rtc::getSeconds(unsigned long long cycles)
+{
+    // A halted clock does not count, so the base is the current value
+    if (this->halted)
+    {
+        return this->baseSeconds;
+    }
+
+    if (this->useHostTime)
+    {
+        return this->baseSeconds + (time(NULL) - this->baseHostTime);
+    }
+
+    return this->baseSeconds + (long long) ((cycles - this->baseCycles) / CLOCK_SPEED);
+}
+
+void Rtc::rebase(long long seconds, unsigned long long cycles)
+{
+    this->baseSeconds = seconds;
+    this->baseCycles = cycles;
+    this->baseHostTime = time(NULL);
+}
+
+void Rtc::decompose(long long seconds, Byte *registers)
+{
+    long long days = seconds / 86400;
+
+    // The day counter is 9 bits - if we go past it, the carry bit
+    // is set and stays set until the game clears it
+    if (days > 511)
+    {
+        this->dayCarry = true;
+    }
+
+    days &= 0x1FF;
+
+    registers[0] = seconds % 60;
+    registers[1] = (seconds / 60) % 60;
+    registers[2] = (seconds / 3600) % 24;
+    registers[3] = days & 0xFF;
+    registers[4] = (days >> 8) & 0x1;
+
+    if (this->halted)
+    {
+        setBit(&registers[4], 6);
+    }
+
+    if (this->dayCarry)
+    {
+        setBit(&registers[4], 7);
+    }
+}
+
+void Rtc::latch(unsigned long long cycles)
+{
+    long long seconds = this->getSeconds(cycles);
+    this->decompose(seconds, this->latched);
+
+    // Once the carry has been reported, fold the overflowed days away
+    // so we aren't carrying around an ever growing number of seconds
+    if (seconds / 86400 > 511)
+    {
+        this->rebase(seconds % (512 * 86400), cycles);
+    }
+}
+
+Byte Rtc::readRegister(Byte reg)
+{
+    // Registers are selected with 0x08 - 0x0C
+    if (reg < 0x08 || reg > 0x0C)
+    {
+        return 0xFF;
+    }
+
+    return this->latched[reg - 0x08];
+}
+
+void Rtc::writeRegister(Byte reg, Byte data, unsigned long long cycles)
+{
+    if (reg < 0x08 || reg > 0x0C)
+    {
+        return;
+    }
+
+    // Writing a register changes the running clock (not just the latched value)
+    // so get the current value, change the one field and then rebase on it
+    Byte registers[5];
+    this->decompose(this->getSeconds(cycles), registers);
+    registers[reg - 0x08] = data;
+    this->latched[reg - 0x08] = data;
+
+    this->halted = isBitSet(registers[4], 6);
+    this->dayCarry = isBitSet(registers[4], 7);
+
+    long long days = ((registers[4] & 0x1) << 8) | registers[3];
+    long long seconds = registers[0] + registers[1] * 60 + registers[2] * 3600 + days * 86400;
+    this->rebase(seconds, cycles);
+}
+
+void Rtc::save(Byte *data, unsigned long long cycles)
+{
+    Byte registers[5];
+    this->decompose(this->getSeconds(cycles), registers);
+
+    memset(data, 0, RTC_SAVE_SIZE);
+    for (int i = 0; i < 5; i++)
+    {
+        data[i * 4] = registers[i];
+        data[20 + i * 4] = this->latched[i];
+    }
+
+    long long timestamp = time(NULL);
+    for (int i = 0; i < 8; i++)
+    {
+        data[40 + i] = (timestamp >> (i * 8)) & 0xFF;
+    }
+}
+
+void Rtc::load(const Byte *data, unsigned long long cycles)
+{
+    Byte registers[5];
+    for (int i = 0; i < 5; i++)
+    {
+        registers[i] = data[i * 4];
+        this->latched[i] = data[20 + i * 4];
+    }
+
+    this->halted = isBitSet(registers[4], 6);
+    this->dayCarry = isBitSet(registers[4], 7);
+
+    long long days = ((registers[4] & 0x1) << 8) | registers[3];
+    long long seconds = registers[0] + registers[1] * 60 + registers[2] * 3600 + days * 86400;
+
+    // If we are following the host clock, the time the emulator was not
+    // running has passed as well. An emulated clock stays where it was saved
+    // so that runs are repeatable
+    if (this->useHostTime && !this->halted)
+    {
+        long long timestamp = 0;
+        for (int i = 0; i < 8; i++)
+        {
+            timestamp |= ((long long) data[40 + i]) << (i * 8);
+        }
+
+        if (timestamp > 0 && timestamp < time(NULL))
+        {
+            seconds += time(NULL) - timestamp;
+        }
+    }
+
+    this->rebase(seconds, cycles);
+}
+
+void Rtc::saveState(StateWriter &state)
+{
+    state.put(this->baseSeconds);
+    state.put(this->baseCycles);
+    state.put(this->baseHostTime);
+    state.put(this->halted);
+    state.put(this->dayCarry);
+    state.write(this->latched, sizeof(this->latched));
+}
+
+void Rtc::loadState(StateReader &state)
+{
+    state.get(this->baseSeconds);
+    state.get(this->baseCycles);
+    state.get(this->baseHostTime);
+    state.get(this->halted);
+    state.get(this->dayCarry);
+    state.read(this->latched, sizeof(this->latched));
+}
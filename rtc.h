@@ -0,0 +1,82 @@
+/**
+ *
+ * MBC3 REAL TIME CLOCK
+ * The MBC3 cartridge has a clock chip with 5 registers that can be mapped
+ * into 0xA000 - 0xBFFF by writing 0x08 - 0x0C to 0x4000 - 0x5FFF:
+ * 08 RTC S   Seconds   0-59
+ * 09 RTC M   Minutes   0-59
+ * 0A RTC H   Hours     0-23
+ * 0B RTC DL  Lower 8 bits of Day Counter
+ * 0C RTC DH  Upper 1 bit of Day Counter, Carry Bit, Halt Flag
+ *   Bit 0  Most significant bit of Day Counter (Bit 8)
+ *   Bit 6  Halt (0=Active, 1=Stop Timer)
+ *   Bit 7  Day Counter Carry Bit (1=Counter Overflow)
+ *
+ * The game sees the registers only after "latching" them (writing 0x00 then
+ * 0x01 to 0x6000 - 0x7FFF), so we never tick the clock. It is kept as a
+ * number of seconds at some base point and the registers are derived from
+ * the emulated cycle count (or the host clock) only when they are latched
+ *
+ **/
+
+#ifndef __RTC_H_INCLUDED__
+#define __RTC_H_INCLUDED__
+
+#include <stdio.h>
+
+#include "savestate.h"
+#include "utils.h"
+
+class Rtc {
+
+    public:
+        Rtc() {};
+
+        // Reset RTC to initial state
+        void reset();
+
+        // By default the clock runs off of emulated time, which keeps runs
+        // deterministic. When enabled, the host wall clock is used instead
+        void setUseHostTime(bool val);
+
+        // Move the clock forward without running any emulation
+        void fastForward(long long seconds);
+
+        // Copy the current time into the registers visible to the game
+        void latch(unsigned long long cycles);
+
+        Byte readRegister(Byte reg);
+        void writeRegister(Byte reg, Byte data, unsigned long long cycles);
+
+        // The RTC is stored after the RAM in the battery save, using the 48 byte
+        // layout most emulators use (5 current registers, 5 latched registers as
+        // 32-bit little endian values, and a 64-bit UNIX timestamp)
+        void save(Byte *data, unsigned long long cycles);
+        void load(const Byte *data, unsigned long long cycles);
+
+        // Unlike the battery save, a save state puts the clock back exactly
+        // as it was (whether it follows the host's clock isn't part of it)
+        void saveState(StateWriter &state);
+        void loadState(StateReader &state);
+
+    private:
+        bool useHostTime = false;
+
+        // Value of the clock (in seconds) when it was last rebased, and
+        // the emulated cycle and host time that it was rebased at
+        long long baseSeconds = 0;
+        unsigned long long baseCycles = 0;
+        long long baseHostTime = 0;
+
+        bool halted = false;
+        bool dayCarry = false;
+
+        // The registers as last latched by the game
+        Byte latched[5] = { 0 };
+
+        long long getSeconds(unsigned long long cycles);
+        void rebase(long long seconds, unsigned long long cycles);
+        void decompose(long long seconds, Byte *registers);
+};
+
+#endif
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "savefile.h"
+#include "utils.h"
+
+using namespace std;
+
+SaveFile::~SaveFile()
+{
+    this->close();
+}
+
+bool SaveFile::open(const char *path, int size)
+{
+    this->close();
+
+    this->fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (this->fd < 0)
+    {
+        return false;
+    }
+
+    // The file needs to be at least as big as the mapping. If it is new
+    // (or too small) growing it will fill the rest with zeros
+    struct stat info;
+    if (fstat(this->fd, &info) != 0)
+    {
+        ::close(this->fd);
+        this->fd = -1;
+        return false;
+    }
+
+    this->created = info.st_size < size;
+    if (this->created && ftruncate(this->fd, size) != 0)
+    {
+        ::close(this->fd);
+        this->fd = -1;
+        return false;
+    }
+
+    void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        ::close(this->fd);
+        this->fd = -1;
+        return false;
+    }
+
+    this->data = (Byte *) mapping;
+    this->size = size;
+    this->dirty = false;
+    this->flushRequested = false;
+    this->stopping = false;
+
+    this->flusher = thread(&SaveFile::flushLoop, this);
+
+    return true;
+}
+
+void SaveFile::close()
+{
+    if (this->data == NULL)
+    {
+        return;
+    }
+
+    // Stop the flushing thread and do a last flush ourselves
+    {
+        lock_guard<mutex> lock(this->flushMutex);
+        this->stopping = true;
+    }
+    this->flushWake.notify_one();
+    this->flusher.join();
+
+    this->dirty = true;
+    this->flush();
+
+    munmap(this->data, this->size);
+    ::close(this->fd);
+
+    this->data = NULL;
+    this->fd = -1;
+    this->size = 0;
+}
+
+bool SaveFile::isOpen()
+{
+    return this->data != NULL;
+}
+
+bool SaveFile::isNew()
+{
+    return this->created;
+}
+
+Byte *SaveFile::getData()
+{
+    return this->data;
+}
+
+void SaveFile::markDirty()
+{
+    this->dirty.store(true, memory_order_relaxed);
+}
+
+void SaveFile::requestFlush()
+{
+    {
+        lock_guard<mutex> lock(this->flushMutex);
+        this->flushRequested = true;
+    }
+    this->flushWake.notify_one();
+}
+
+void SaveFile::flushLoop()
+{
+    unique_lock<mutex> lock(this->flushMutex);
+    while (!this->stopping)
+    {
+        this->flushWake.wait_for(lock, chrono::milliseconds(SAVE_FLUSH_INTERVAL_MS), [this] {
+            return this->flushRequested || this->stopping;
+        });
+
+        if (this->stopping)
+        {
+            break;
+        }
+
+        this->flushRequested = false;
+
+        // Don't hold the lock while writing so the emulation thread
+        // can never be blocked by the disk
+        lock.unlock();
+        this->flush();
+        lock.lock();
+    }
+}
+
+void SaveFile::flush()
+{
+    // The mapping is shared, so the data is already in the page cache and
+    // survives the emulator crashing. This makes sure it is on disk as well
+    if (this->dirty.exchange(false))
+    {
+        if (msync(this->data, this->size, MS_SYNC) != 0)
+        {
+            cout << "Unable to flush save data" << endl;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ *
+ * BATTERY SAVE FILE
+ * Cartridge RAM that is battery backed is kept in a memory-mapped .sav file,
+ * so the game writes straight into the page cache and nothing needs to be
+ * copied out when saving. Getting the data onto disk (msync) can block, so
+ * that is done on a background thread - either when asked to (i.e. when the
+ * game disables RAM, which is what games do after saving) or periodically
+ * if the RAM has been written to since the last flush
+ *
+ **/
+
+#ifndef __SAVEFILE_H_INCLUDED__
+#define __SAVEFILE_H_INCLUDED__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "utils.h"
+
+class SaveFile {
+
+    public:
+        SaveFile() {};
+        ~SaveFile();
+
+        // Map the file at path (creating it if needed) with the given size
+        // Returns false if the file couldn't be mapped
+        bool open(const char *path, int size);
+
+        // Flush anything outstanding and unmap the file. This blocks
+        // until the data is written so should only be used on exit
+        void close();
+
+        bool isOpen();
+
+        // True if the file did not exist (or was too small) before opening
+        bool isNew();
+
+        Byte *getData();
+
+        // Note that the mapping has been written to. This is called on
+        // every RAM write, so it only sets a flag
+        void markDirty();
+
+        // Wake up the flushing thread to write out any changes now
+        void requestFlush();
+
+    private:
+        int fd = -1;
+        Byte *data = NULL;
+        int size = 0;
+        bool created = false;
+
+        std::atomic<bool> dirty { false };
+
+        std::thread flusher;
+        std::mutex flushMutex;
+        std::condition_variable flushWake;
+        bool flushRequested = false;
+        bool stopping = false;
+
+        void flushLoop();
+        void flush();
+};
+
+#endif
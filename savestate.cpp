@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <iostream>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "savestate.h"
+#include "utils.h"
+
+using namespace std;
+
+static const char STATE_MAGIC[8] = { 'G', 'B', 'S', 'T', 'A', 'T', 'E', 0 };
+
+// The header a state of the given size from the cartridge and renderer has
+// (see savestate.h)
+static void writeHeader(vector<Byte> &header, const Cartridge &cartridge, Word renderer, size_t stateSize)
+{
+    char title[TITLE_LENGTH] = {};
+    string name = cartridge.getTitle();
+    memcpy(title, name.data(), name.size() < (size_t) TITLE_LENGTH ? name.size() : TITLE_LENGTH);
+
+    StateWriter writer(header);
+    writer.write(STATE_MAGIC, sizeof(STATE_MAGIC));
+    writer.put(SAVE_STATE_VERSION);
+    writer.put((unsigned int) SAVE_STATE_HEADER_SIZE);
+    writer.put((unsigned int) stateSize);
+    writer.put(cartridge.getChecksum());
+    writer.put(renderer);
+    writer.write(title, sizeof(title));
+
+    header.resize(SAVE_STATE_HEADER_SIZE, 0);
+}
+
+StateFile::~StateFile()
+{
+    this->close();
+}
+
+bool StateFile::write(const char *path, const Cartridge &cartridge, Word renderer, const vector<Byte> &state)
+{
+    vector<Byte> header;
+    writeHeader(header, cartridge, renderer, state.size());
+
+    string temporaryPath = string(path) + ".tmp";
+    FILE *file = fopen(temporaryPath.c_str(), "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    bool ok = fwrite(header.data(), 1, header.size(), file) == header.size();
+    ok = ok && fwrite(state.data(), 1, state.size(), file) == state.size();
+    ok = fclose(file) == 0 && ok;
+
+    // Only now is there a whole state to replace the old one with
+    if (!ok || rename(temporaryPath.c_str(), path) != 0)
+    {
+        remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool StateFile::open(const char *path, const Cartridge &cartridge, Word renderer)
+{
+    this->close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < SAVE_STATE_HEADER_SIZE)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping stays valid after the file is closed
+    void *mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    this->mapping = mapping;
+    this->mappingSize = info.st_size;
+
+    const Byte *data = (const Byte *) mapping;
+    StateReader reader(data, SAVE_STATE_HEADER_SIZE);
+    char magic[sizeof(STATE_MAGIC)];
+    unsigned int version;
+    unsigned int headerSize;
+    unsigned int stateSize;
+    Word checksum;
+    Word stateRenderer;
+    reader.read(magic, sizeof(magic));
+    reader.get(version);
+    reader.get(headerSize);
+    reader.get(stateSize);
+    reader.get(checksum); // Checked with the rest of the header below
+    reader.get(stateRenderer);
+
+    if (memcmp(magic, STATE_MAGIC, sizeof(magic)) != 0)
+    {
+        cout << path << " isn't a save state" << endl;
+        this->close();
+        return false;
+    }
+
+    if (version != SAVE_STATE_VERSION || headerSize != (unsigned int) SAVE_STATE_HEADER_SIZE)
+    {
+        cout << path << " is version " << version << " of the save state format, not " << SAVE_STATE_VERSION << endl;
+        this->close();
+        return false;
+    }
+
+    if ((size_t) headerSize + stateSize > this->mappingSize)
+    {
+        cout << path << " is cut short" << endl;
+        this->close();
+        return false;
+    }
+
+    if (stateRenderer != renderer)
+    {
+        cout << path << " was saved with the other renderer" << endl;
+        this->close();
+        return false;
+    }
+
+    // Everything else in the header is worked out from the cartridge
+    vector<Byte> expected;
+    writeHeader(expected, cartridge, renderer, stateSize);
+    if (memcmp(data, expected.data(), SAVE_STATE_HEADER_SIZE) != 0)
+    {
+        cout << path << " was saved from another ROM" << endl;
+        this->close();
+        return false;
+    }
+
+    this->stateSize = stateSize;
+    return true;
+}
+
+void StateFile::close()
+{
+    if (this->mapping != NULL)
+    {
+        munmap(this->mapping, this->mappingSize);
+    }
+
+    this->mapping = NULL;
+    this->mappingSize = 0;
+    this->stateSize = 0;
+}
+
+const Byte *StateFile::getState()
+{
+    return (const Byte *) this->mapping + SAVE_STATE_HEADER_SIZE;
+}
+
+size_t StateFile::getStateSize()
+{
+    return this->stateSize;
+}
@@ -0,0 +1,199 @@
+/**
+ *
+ * SAVE STATE
+ * Everything the emulation depends on (registers, memory, the state of the
+ * timer, PPU, APU and so on) written out as bytes, so it can be put back
+ * later. Each part of an instance writes its own state with saveState and
+ * reads it back in the same order with loadState.
+ *
+ * Anything that can be worked out from the rest (i.e. the page table or the
+ * decoded tiles) isn't written - it is rebuilt when the state is loaded.
+ * Neither is anything that belongs to the host rather than the Gameboy (the
+ * audio output and its rate, the buttons held, the display's output).
+ *
+ * Integers are written little-endian with the size of the field they came
+ * from, whatever the host is, and blocks of memory as they are. Writing
+ * goes into a vector that is reused, so once it has grown to the size of a
+ * state, saving doesn't allocate.
+ *
+ * A state is flat - every field is at the same place in every state for the
+ * same version and cartridge (only the external RAM is sized by the
+ * cartridge) and there are no pointers. So a state file is a header
+ * followed by the state exactly as it is in memory, and loading one maps
+ * the file and reads straight from it. The header is SAVE_STATE_HEADER_SIZE
+ * bytes, little-endian:
+ *  0   "GBSTATE\0"
+ *  8   Version (4 bytes, SAVE_STATE_VERSION)
+ *  12  Header size (4 bytes, where the state starts)
+ *  16  State size (4 bytes)
+ *  20  Global checksum of the ROM (2 bytes)
+ *  22  Renderer (2 bytes, SAVE_STATE_RENDERER_*)
+ *  24  Title of the ROM (16 bytes, padded with zeros)
+ *  40  Zeros, up to the header size
+ * A state is only loaded into the ROM and renderer it was saved with
+ *
+ **/
+
+#ifndef __SAVESTATE_H_INCLUDED__
+#define __SAVESTATE_H_INCLUDED__
+
+#include <stddef.h>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "cartridge.h"
+#include "utils.h"
+
+class StateWriter {
+
+    public:
+        // Everything is written after what is already in the buffer
+        StateWriter(std::vector<Byte> &_buffer) : buffer(_buffer) {};
+
+        // A block of bytes as it is
+        void write(const void *data, size_t size)
+        {
+            size_t position = this->buffer.size();
+            this->buffer.resize(position + size);
+            memcpy(this->buffer.data() + position, data, size);
+        }
+
+        // An integer (or bool), little-endian
+        template <class T>
+        void put(T value)
+        {
+            static_assert(std::is_integral<T>::value, "Only integers can be put");
+
+            Byte bytes[sizeof(T)];
+            unsigned long long bits = (unsigned long long) value;
+            for (size_t i = 0; i < sizeof(T); i++)
+            {
+                bytes[i] = (bits >> (i * 8)) & 0xFF;
+            }
+
+            this->write(bytes, sizeof(T));
+        }
+
+        // A float, as the bits of an IEEE single
+        void putFloat(float value)
+        {
+            unsigned int bits;
+            memcpy(&bits, &value, sizeof(bits));
+            this->put(bits);
+        }
+
+    private:
+        std::vector<Byte> &buffer;
+};
+
+class StateReader {
+
+    public:
+        StateReader(const Byte *_data, size_t _size) : data(_data), size(_size) {};
+
+        // Reading past the end gives zeros, and the state is no longer valid
+        void read(void *out, size_t count)
+        {
+            if (count > this->size - this->position)
+            {
+                memset(out, 0, count);
+                this->position = this->size;
+                this->failed = true;
+                return;
+            }
+
+            memcpy(out, this->data + this->position, count);
+            this->position += count;
+        }
+
+        // A block of bytes, straight from the state rather than copied.
+        // Returns NULL (and the state is no longer valid) if it isn't there
+        const Byte *readBlock(size_t count)
+        {
+            if (count > this->size - this->position)
+            {
+                this->position = this->size;
+                this->failed = true;
+                return NULL;
+            }
+
+            const Byte *block = this->data + this->position;
+            this->position += count;
+            return block;
+        }
+
+        template <class T>
+        void get(T &value)
+        {
+            static_assert(std::is_integral<T>::value, "Only integers can be got");
+
+            Byte bytes[sizeof(T)];
+            this->read(bytes, sizeof(T));
+
+            unsigned long long bits = 0;
+            for (size_t i = 0; i < sizeof(T); i++)
+            {
+                bits |= (unsigned long long) bytes[i] << (i * 8);
+            }
+
+            value = (T) bits;
+        }
+
+        void getFloat(float &value)
+        {
+            unsigned int bits;
+            this->get(bits);
+            memcpy(&value, &bits, sizeof(value));
+        }
+
+        // For a state that doesn't fit what it is being loaded into
+        void fail()
+        {
+            this->failed = true;
+        }
+
+        // True if everything read was there, and all of it was read
+        bool isValid()
+        {
+            return !this->failed && this->position == this->size;
+        }
+
+    private:
+        const Byte *data;
+        size_t size;
+        size_t position = 0;
+        bool failed = false;
+};
+
+// A state on disk
+class StateFile {
+
+    public:
+        StateFile() {};
+        ~StateFile();
+
+        StateFile(const StateFile &) = delete;
+        StateFile &operator=(const StateFile &) = delete;
+
+        // Write a state saved from the cartridge with the renderer. It goes
+        // to a temporary file first, so a state already at path is only
+        // replaced by a whole one
+        static bool write(const char *path, const Cartridge &cartridge, Word renderer, const std::vector<Byte> &state);
+
+        // Map the state at path. Returns false if it can't be read, isn't a
+        // state, is another version or is for another cartridge or renderer
+        bool open(const char *path, const Cartridge &cartridge, Word renderer);
+        void close();
+
+        // The state (after the header), straight from the mapped file
+        const Byte *getState();
+        size_t getStateSize();
+
+    private:
+        void *mapping = NULL;
+        size_t mappingSize = 0;
+        size_t stateSize = 0;
+};
+
+#endif
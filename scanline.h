@@ -0,0 +1,83 @@
+/**
+ *
+ * SCANLINE RENDERER
+ * The fast renderer for the PPU (see ppu.h). Mode 3 is always 172 cycles,
+ * and the display draws whole lines from the registers latched when mode 3
+ * starts, as a batch at V-Blank. Changes to registers part way through a
+ * line don't show up until the next line
+ *
+ **/
+
+#ifndef __SCANLINE_H_INCLUDED__
+#define __SCANLINE_H_INCLUDED__
+
+#include "display.h"
+#include "mmu.h"
+#include "savestate.h"
+#include "utils.h"
+
+class ScanlineRenderer {
+
+    public:
+        static const Word STATE_ID = SAVE_STATE_RENDERER_SCANLINE;
+
+        ScanlineRenderer(Mmu *_mmu, Display *_display) : display(_display) { (void) _mmu; };
+
+        void reset()
+        {
+            this->cycles = 0;
+        }
+
+        void startTransfer(int line)
+        {
+            this->display->latchScanline(line);
+            this->cycles = 0;
+        }
+
+        int transfer(int cycles)
+        {
+            int used = cycles < TRANSFER_CYCLES - this->cycles ? cycles : TRANSFER_CYCLES - this->cycles;
+            this->cycles += used;
+            return used;
+        }
+
+        bool isTransferDone()
+        {
+            return this->cycles >= TRANSFER_CYCLES;
+        }
+
+        int getTransferWait()
+        {
+            // Mode 3 is always the same length
+            return TRANSFER_CYCLES - this->cycles;
+        }
+
+        void finishFrame()
+        {
+            // Every visible line has been latched, so draw the frame
+            this->display->finishFrame();
+        }
+
+        void disable()
+        {
+            // Draw anything latched before the LCD was turned off
+            this->display->flush();
+        }
+
+        void saveState(StateWriter &state)
+        {
+            state.put(this->cycles);
+        }
+
+        void loadState(StateReader &state)
+        {
+            state.get(this->cycles);
+        }
+
+    private:
+        Display *display;
+
+        int cycles = 0;
+};
+
+#endif
@@ -0,0 +1,138 @@
+/**
+ *
+ * SCHEDULER
+ * Rather than checking on every instruction if something time based needs to
+ * happen (i.e. a DMA transfer finishing), components schedule an event for the
+ * cycle it will happen at. The main loop only has to compare the clock against
+ * the time of the next event, and handles any that are due
+ *
+ * There is only ever one pending event of each type, so scheduling an event
+ * that is already pending moves it
+ *
+ **/
+
+#ifndef __SCHEDULER_H_INCLUDED__
+#define __SCHEDULER_H_INCLUDED__
+
+#include "savestate.h"
+#include "utils.h"
+
+enum EventType {
+    EVENT_DMA_END,
+    EVENT_PPU,
+    EVENT_TIMER,
+    EVENT_COUNT
+};
+
+const unsigned long long EVENT_NEVER = ~0ULL;
+
+class Scheduler {
+
+    public:
+        void reset()
+        {
+            for (int i = 0; i < EVENT_COUNT; i++)
+            {
+                this->times[i] = EVENT_NEVER;
+            }
+
+            this->nextTime = EVENT_NEVER;
+        }
+
+        void schedule(EventType type, unsigned long long time)
+        {
+            // If this was the next event and it is moving later, something
+            // else might be next now
+            bool wasNext = this->times[type] == this->nextTime;
+
+            this->times[type] = time;
+            if (time < this->nextTime)
+            {
+                this->nextTime = time;
+            }
+            else if (wasNext)
+            {
+                this->updateNextTime();
+            }
+        }
+
+        void cancel(EventType type)
+        {
+            this->times[type] = EVENT_NEVER;
+            this->updateNextTime();
+        }
+
+        bool isScheduled(EventType type)
+        {
+            return this->times[type] != EVENT_NEVER;
+        }
+
+        unsigned long long getTime(EventType type)
+        {
+            return this->times[type];
+        }
+
+        // This is all the main loop checks after each instruction
+        unsigned long long getNextTime()
+        {
+            return this->nextTime;
+        }
+
+        // Take the earliest event that is due at or before now off the schedule
+        // Returns EVENT_COUNT if there are none
+        int popDue(unsigned long long now)
+        {
+            int due = EVENT_COUNT;
+            for (int i = 0; i < EVENT_COUNT; i++)
+            {
+                if (this->times[i] <= now && (due == EVENT_COUNT || this->times[i] < this->times[due]))
+                {
+                    due = i;
+                }
+            }
+
+            if (due != EVENT_COUNT)
+            {
+                this->times[due] = EVENT_NEVER;
+                this->updateNextTime();
+            }
+
+            return due;
+        }
+
+        void saveState(StateWriter &state)
+        {
+            for (int i = 0; i < EVENT_COUNT; i++)
+            {
+                state.put(this->times[i]);
+            }
+        }
+
+        void loadState(StateReader &state)
+        {
+            for (int i = 0; i < EVENT_COUNT; i++)
+            {
+                state.get(this->times[i]);
+            }
+
+            this->updateNextTime();
+        }
+
+    private:
+        unsigned long long times[EVENT_COUNT];
+        unsigned long long nextTime = EVENT_NEVER;
+
+        void updateNextTime()
+        {
+            this->nextTime = EVENT_NEVER;
+            for (int i = 0; i < EVENT_COUNT; i++)
+            {
+                if (this->times[i] < this->nextTime)
+                {
+                    this->nextTime = this->times[i];
+                }
+            }
+        }
+};
+
+#endif
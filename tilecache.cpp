@@ -0,0 +1,19 @@
+#include "tilecache.h"
+#include "utils.h"
+
+void TileCache::reset(const Byte *tileData)
+{
+    this->pixelOps->decodeTileLines(tileData, &this->pixels[0][0][0], TILE_COUNT * 8);
+}
+
+void TileCache::update(const Byte *tileData, Word offset)
+{
+    if (offset >= TILE_DATA_SIZE)
+    {
+        return;
+    }
+
+    // Each tile line is two bytes, so both bytes map to the same line
+    int tileLine = offset >> 1;
+    this->pixelOps->decodeTileLines(tileData + tileLine * 2, &this->pixels[0][0][0] + tileLine * 8, 1);
+}
@@ -0,0 +1,42 @@
+/**
+ *
+ * TILE CACHE
+ * Tile data lives in VRAM 0x8000 - 0x97FF as 384 tiles of 16 bytes. Each line
+ * of a tile is two bytes (bitplanes), and the color of a pixel is made of one
+ * bit from each. Rather than pull the bits apart for every pixel we draw, every
+ * tile is kept here already decoded to one color index (0 - 3) per pixel.
+ *
+ * VRAM is written far less often than it is drawn, so each write to tile data
+ * re-decodes only the line of the tile it lands in
+ *
+ **/
+
+#ifndef __TILECACHE_H_INCLUDED__
+#define __TILECACHE_H_INCLUDED__
+
+#include "pixelops.h"
+#include "utils.h"
+
+class TileCache {
+
+    public:
+        // Decode every tile from the given tile data (the start of VRAM)
+        void reset(const Byte *tileData);
+
+        // Re-decode the tile line containing offset (from the start of VRAM)
+        // Offsets past the tile data are ignored
+        void update(const Byte *tileData, Word offset);
+
+        // The 8 color indices of a line of a tile (0 - 383), left to right
+        const Byte *getLine(int tile, int line) const
+        {
+            return this->pixels[tile][line];
+        }
+
+    private:
+        Byte pixels[TILE_COUNT][8][8];
+
+        const PixelOps *pixelOps = getPixelOps();
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "timer.h"
+#include "utils.h"
+
+void Timer::reset()
+{
+    this->counterStart = this->core->clock;
+    this->timer = 0;
+    this->timerCounter = 0;
+    this->timerModulator = 0;
+    this->timerController = 0;
+    this->core->scheduler.cancel(EVENT_TIMER);
+}
+
+unsigned long long Timer::getCounter()
+{
+    return this->core->clock - this->counterStart;
+}
+
+bool Timer::isTimerEnabled()
+{
+    // Bit 2 of the timer controller specifies if the timer is enabled
+    return isBitSet(this->timerController, 2);
+}
+
+int Timer::getTimerShift()
+{
+    // The first two bits of the timer controller select the frequency. The
+    // timer goes up when bit (shift - 1) of the counter drops, which is
+    // every (1 << shift) cycles:
+    //   4096 Hz = CLOCK_SPEED / 1024, etc.
+    switch (this->timerController & 0x3)
+    {
+        case 0x0: return 10;
+        case 0x1: return 4;
+        case 0x2: return 6;
+        default: return 8;
+    }
+}
+
+Byte Timer::readRegister(Word address)
+{
+    switch (address)
+    {
+        case DIVIDER_REGISTER_ADDR: return (this->getCounter() >> 8) & 0xFF;
+        case TIMER_ADDR: this->updateTimer(); return this->timer;
+        case TIMER_MODULATOR_ADDR: return this->timerModulator;
+        default: return this->timerController | 0b11111000; // Unused bits read as 1
+    }
+}
+
+void Timer::writeRegister(Word address, Byte data)
+{
+    // Anything written changes how the timer counts from now on
+    this->updateTimer();
+
+    int shift = this->getTimerShift();
+    bool wasHigh = this->isTimerEnabled() && ((this->getCounter() >> (shift - 1)) & 1);
+
+    switch (address)
+    {
+        case DIVIDER_REGISTER_ADDR:
+            // Writing any value zeroes the counter (and so DIV). If the bit
+            // the timer is watching was 1, that is a falling edge
+            this->counterStart = this->core->clock;
+            this->timerCounter = 0;
+            if (wasHigh)
+            {
+                this->increaseTimer();
+            }
+            break;
+
+        case TIMER_ADDR:
+            this->timer = data;
+            break;
+
+        case TIMER_MODULATOR_ADDR:
+            this->timerModulator = data;
+            break;
+
+        default:
+        {
+            // If the watched bit was 1 and now the timer is off or watching
+            // a bit that is 0, that is a falling edge too
+            this->timerController = data & 0x7;
+            int newShift = this->getTimerShift();
+            bool isHigh = this->isTimerEnabled() && ((this->getCounter() >> (newShift - 1)) & 1);
+            if (wasHigh && !isHigh)
+            {
+                this->increaseTimer();
+            }
+            break;
+        }
+    }
+
+    this->scheduleOverflow();
+}
+
+void Timer::updateTimer()
+{
+    unsigned long long counter = this->getCounter();
+    if (this->isTimerEnabled())
+    {
+        // The number of falling edges since then is the number of times
+        // the counter has passed a multiple of (1 << shift)
+        int shift = this->getTimerShift();
+        unsigned long long edges = (counter >> shift) - (this->timerCounter >> shift);
+
+        // It can't have overflowed, as that is an event which would have
+        // brought it up to date already
+        this->timer += edges;
+    }
+
+    this->timerCounter = counter;
+}
+
+void Timer::increaseTimer()
+{
+    // An extra tick, i.e. from writing DIV or TAC
+    this->timer++;
+    if (this->timer == 0)
+    {
+        this->timer = this->timerModulator;
+        this->core->requestInterrupt(2);
+    }
+}
+
+void Timer::scheduleOverflow()
+{
+    if (!this->isTimerEnabled())
+    {
+        this->core->scheduler.cancel(EVENT_TIMER);
+        return;
+    }
+
+    this->core->scheduler.schedule(EVENT_TIMER, this->counterStart + this->getOverflowCounter());
+}
+
+unsigned long long Timer::getOverflowCounter()
+{
+    // TIMA overflows on the (256 - TIMA)th falling edge from when it was
+    // stored. Edges are at each multiple of (1 << shift) on the counter
+    int shift = this->getTimerShift();
+    return ((this->timerCounter >> shift) + (256 - this->timer)) << shift;
+}
+
+void Timer::overflow()
+{
+    // Work from when the overflow was due rather than now, as the event is
+    // only handled at the end of the instruction it happened during
+    this->timerCounter = this->getOverflowCounter();
+    this->timer = this->timerModulator;
+
+    // Request the timer interrupt (bit 2)
+    this->core->requestInterrupt(2);
+
+    this->scheduleOverflow();
+}
+
+void Timer::saveState(StateWriter &state)
+{
+    state.put(this->counterStart);
+    state.put(this->timer);
+    state.put(this->timerCounter);
+    state.put(this->timerModulator);
+    state.put(this->timerController);
+}
+
+void Timer::loadState(StateReader &state)
+{
+    state.get(this->counterStart);
+    state.get(this->timer);
+    state.get(this->timerCounter);
+    state.get(this->timerModulator);
+    state.get(this->timerController);
+}
@@ -0,0 +1,80 @@
+/**
+ *
+ * TIMER
+ * The divider (DIV, 0xFF04) and the timer (TIMA, 0xFF05) both come from one
+ * 16-bit counter that goes up every cycle. DIV is its top 8 bits, and TIMA
+ * goes up every time the counter bit selected by TAC (0xFF07) goes from 1
+ * to 0:
+ *  00: bit 9 (4096 Hz)
+ *  01: bit 3 (262144 Hz)
+ *  10: bit 5 (65536 Hz)
+ *  11: bit 7 (16384 Hz)
+ *
+ * Rather than counting every cycle, we keep the clock cycle the counter was
+ * last zeroed at, and the value TIMA had at some point. The registers are
+ * worked out from the clock only when they are read. When TIMA will overflow
+ * is known in advance, so it is an event (see scheduler.h) which reloads it
+ * from TMA (0xFF06) and requests the timer interrupt.
+ *
+ * Because TIMA counts falling edges, anything that makes the selected bit
+ * drop also counts - writing to DIV (which zeroes the counter) and changing
+ * TAC so a bit that was 1 is no longer selected. Both are done like the
+ * hardware does
+ *
+ **/
+
+#ifndef __TIMER_H_INCLUDED__
+#define __TIMER_H_INCLUDED__
+
+#include "core.h"
+#include "savestate.h"
+#include "utils.h"
+
+class Timer {
+
+    public:
+        Timer(Core *_core) : core(_core) {};
+
+        void reset();
+
+        // DIV, TIMA, TMA and TAC
+        Byte readRegister(Word address);
+        void writeRegister(Word address, Byte data);
+
+        // Called when the timer overflow event is due
+        void overflow();
+
+        // The overflow event is in the scheduler, which the core saves
+        void saveState(StateWriter &state);
+        void loadState(StateReader &state);
+
+    private:
+        // The clock and scheduler are in the core block
+        Core *core;
+
+        // The clock cycle the counter was last zeroed at. The counter is
+        // worked out from the clock, and isn't wrapped at 16 bits so that
+        // falling edges can be counted by dividing
+        unsigned long long counterStart = 0;
+
+        // TIMA had this value when the counter was at timerCounter
+        Byte timer = 0;
+        unsigned long long timerCounter = 0;
+
+        Byte timerModulator = 0;
+        Byte timerController = 0;
+
+        unsigned long long getCounter();
+        bool isTimerEnabled();
+
+        // The timer goes up once every (1 << shift) cycles
+        int getTimerShift();
+
+        // Bring the stored TIMA up to now (before anything changes how it counts)
+        void updateTimer();
+        void increaseTimer();
+        void scheduleOverflow();
+        unsigned long long getOverflowCounter();
+};
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef __UTILS_H_INCLUDED__
 #define __UTILS_H_INCLUDED__
 
+#include <stddef.h>
+
 typedef unsigned char Byte;
 typedef char SignedByte;
 typedef unsigned short Word;
@@ -21,21 +23,59 @@ union Register {
 
 // Color struct to hold RGB values
 struct Color {
-    int red;
-    int green;
-    int blue;
+    Byte red;
+    Byte green;
+    Byte blue;
+};
+
+// The screen only stores shades (0 - 3). These are the colors they are shown
+// as, lightest to darkest, which can be swapped with Display::setOutputPalette
+const Color OUTPUT_PALETTE_GREY[4] = {
+    { 0xFF, 0xFF, 0xFF },
+    { 0xCC, 0xCC, 0xCC },
+    { 0x77, 0x77, 0x77 },
+    { 0x00, 0x00, 0x00 }
+};
+
+// The green of the original Gameboy screen
+const Color OUTPUT_PALETTE_GREEN[4] = {
+    { 0x9B, 0xBC, 0x0F },
+    { 0x8B, 0xAC, 0x0F },
+    { 0x30, 0x62, 0x30 },
+    { 0x0F, 0x38, 0x0F }
 };
 
 const int CLOCK_SPEED = 4194304; // cycles/sec
 const double FRAMES_PER_SECOND = 59.73;
 const int MAX_CYCLES_PER_FRAME = 70221; // Math.floor(4194304 / 59.73)
 
-const int CARTRIDGE_SIZE = 0x200000;
+const int CARTRIDGE_SIZE = 0x200000; // Largest cartridge we support
 const int MEMORY_ROM_SIZE = 0x8000;
 const int MEMORY_SIZE = 0x10000;
+const int ROM_BANK_SIZE = 0x4000;
+
+// Only the parts of memory that aren't in the cartridge are stored,
+// and each region is kept in its own array starting at these addresses
+const int VIDEO_RAM_START = 0x8000;
+const int VIDEO_RAM_SIZE = 0x2000;
+const int WORK_RAM_START = 0xC000;
+const int WORK_RAM_SIZE = 0x2000;
+const int HIGH_MEMORY_START = 0xFE00; // OAM, I/O ports, HRAM and the interrupt enable register
+const int HIGH_MEMORY_SIZE = 0x200;
+
+// Tile data is the first 0x1800 bytes of VRAM - 384 tiles of 16 bytes each
+const int TILE_COUNT = 384;
+const int TILE_DATA_SIZE = 0x1800;
+
+// After the tile data are the two tile maps, 32x32 tiles (256x256 pixels) each
+const int BACKGROUND_MAP_TILES = 0x400;
+const int BACKGROUND_MAP_SIZE = 256;
 const int SCREEN_WIDTH = 160;
 const int SCREEN_HEIGHT = 144;
 const int MAX_SCANLINES = 153; // There are 9 invisible scanlines (past 144)
+const int SCANLINE_CYCLES = 456;
+const int OAM_SEARCH_CYCLES = 80; // Mode 2
+const int TRANSFER_CYCLES = 172; // Mode 3, at its shortest
 
 // Flag Bits in Register F
 const int ZERO_BIT = 7;
@@ -43,11 +83,37 @@ const int SUBTRACT_BIT = 6;
 const int HALF_CARRY_BIT = 5;
 const int CARRY_BIT = 4;
 
+// Cartridge header
+const int TITLE_ADDR = 0x134;
+const int TITLE_LENGTH = 16;
+const int GLOBAL_CHECKSUM_ADDR = 0x14E; // 2 bytes, big endian
+
 // Banking
 const int ROM_BANKING_MODE_ADDR = 0x147;
 const int RAM_BANK_COUNT_ADDR = 0x148;
+const int ROM_SIZE_ADDR = 0x148; // ROM is 32KB << value
 const int MAXIMUM_RAM_BANKS = 4;
 const int RAM_BANK_SIZE = 0x2000; // In bytes
+const int RAM_SIZE_ADDR = 0x149;
+
+// MBC3 Real Time Clock
+// Writing 0x08 - 0x0C to 0x4000 - 0x5FFF maps an RTC register into 0xA000 - 0xBFFF
+// instead of a RAM bank. The clock is stored in the battery save after the RAM
+const int RTC_REGISTER_SELECT_MIN = 0x08;
+const int RTC_SAVE_SIZE = 48; // In bytes
+
+// How often battery saves are flushed to disk if the game doesn't disable RAM
+const int SAVE_FLUSH_INTERVAL_MS = 1000;
+
+// Save states (see savestate.h). The version goes up whenever anything in a
+// state changes, and states of any other version aren't loaded
+const unsigned int SAVE_STATE_VERSION = 1;
+const int SAVE_STATE_HEADER_SIZE = 64;
+
+// The renderer a state was saved with (see ppu.h). Its state is part of the
+// PPU's, so a state only fits an instance with the same one
+const Word SAVE_STATE_RENDERER_SCANLINE = 1;
+const Word SAVE_STATE_RENDERER_PIXEL_FIFO = 2;
 
 // Timers
 const int DIVIDER_REGISTER_ADDR = 0xFF04;
@@ -65,6 +131,46 @@ const int TIMER_MODULATOR_ADDR = 0xFF06; // The value at this address is what th
 // This is the memory address that the controller is stored at
 const int TIMER_CONTROLLER_ADDR = 0xFF07;
 
+// Sound
+// The sound registers are 0xFF10 - 0xFF26 (NR10 - NR52), and 0xFF30 - 0xFF3F
+// is the wave pattern RAM for channel 3
+const int SOUND_REGISTERS_START = 0xFF10;
+const int SOUND_REGISTERS_END = 0xFF3F;
+const int SOUND_CONTROL_ADDR = 0xFF26; // NR52 - bit 7 turns all sound on/off
+const int WAVE_RAM_START = 0xFF30;
+
+// The frame sequencer clocks length counters, sweep and envelopes at 512 Hz
+const int FRAME_SEQUENCER_CYCLES = CLOCK_SPEED / 512;
+
+// Audio is played as 16-bit stereo at this rate. The buffer between the
+// emulator and the audio device can hold ~190ms, and the device asks for
+// ~6ms at a time
+const int AUDIO_SAMPLE_RATE = 44100;
+const int AUDIO_BUFFER_FRAMES = 8192; // Must be a power of two
+const int AUDIO_DEVICE_FRAMES = 256;
+
+// Dynamic rate control (see Apu::controlRate). The output rate is nudged by
+// up to 0.5% to keep what is left in the buffer just before each frame is
+// made at two device requests (~12ms), rather than letting it fill up or run
+// dry as the frame timer and the sound card drift apart. The integral gain
+// takes out a steady drift over a couple of seconds
+const int AUDIO_TARGET_FRAMES = 2 * AUDIO_DEVICE_FRAMES;
+const double AUDIO_MAX_RATE_ADJUSTMENT = 0.005;
+const double AUDIO_RATE_INTEGRAL_GAIN = 0.01;
+
+// Rendering audio to a file (see wavwriter.h) hands it to the writing thread
+// in chunks of ~370ms, and waits if there are 8 waiting to be written
+const int WAV_CHUNK_FRAMES = 16384;
+const int WAV_QUEUE_CHUNKS = 8;
+
+// Band-limited synthesis (see blipbuffer.h). The buffer is flushed at least
+// every frame sequencer step (~94 samples at 48 kHz), so it only needs room
+// for a couple of those. The kernel is 16 samples wide, in 64 phases
+const int BLIP_BUFFER_SAMPLES = 256;
+const int BLIP_KERNEL_WIDTH = 16;
+const int BLIP_KERNEL_PHASE_BITS = 6;
+const int BLIP_KERNEL_PHASES = 1 << BLIP_KERNEL_PHASE_BITS;
+
 // Interrupts
 // There are 4 types of interrupts that can occur and the following are the bits
 // that are set in the enabled register and request register when they occur
@@ -75,6 +181,7 @@ const int TIMER_CONTROLLER_ADDR = 0xFF07;
 // Bit 4: Joypad Interupt
 const int INTERRUPT_ENABLED_REGISTER = 0xFFFF;
 const int INTERRUPT_REQUEST_ADDR = 0xFF0F;
+const int INTERRUPT_MASK = 0x1F; // Only the bottom 5 bits are interrupts
 
 // LCD and Graphics
 const int CURRENT_SCANLINE_ADDR = 0xFF44;
@@ -119,6 +226,10 @@ const int LCD_CONTROL_ADDR = 0xFF40;
 // flag is set and so is this bit, then we will request a LCD interrupt
 const int LCD_STATUS_ADDR = 0xFF41;
 
+// LY Compare. The coincidence flag in the LCD status is set while the
+// current scanline is this value
+const int LYC_ADDR = 0xFF45;
+
 // The screen is only 160x144 but there is 256x256 bytes of screen data
 // We only need to draw what should be visible. The following specify
 // where to start drawing the background and window
@@ -148,6 +259,13 @@ const int SPRITE_COLOR_PALETTE_2_ADDR = 0xFF49;
 // This is the starting point of the sprite attribute table. We need to look at 4 bytes per sprite in
 // the memory range starting from here
 const int SPRITE_ATTRIBUTE_TABLE_ADDR = 0xFE00;
+const int OAM_SIZE = 0xA0;
+const int SPRITE_COUNT = 40;
+const int MAX_SPRITES_PER_LINE = 10; // The hardware only draws the first 10 sprites on a line
+
+// Writing here starts a DMA transfer to OAM, which takes 160 M-cycles
+const int DMA_ADDR = 0xFF46;
+const int DMA_CYCLES = 640;
 
 // The joypad register is found here
 // Bits 7 and 6 are not used
@@ -159,6 +277,48 @@ const int SPRITE_ATTRIBUTE_TABLE_ADDR = 0xFE00;
 // Bit 0 specified if Right or A is pressed (0 is pressed)
 const int JOYPAD_REGISTER_ADDR = 0xFF00;
 
+// Key presses waiting for the emulator to take them (see joypad.h). A power
+// of two, and far more than can come in between two frames
+const int JOYPAD_QUEUE_EVENTS = 64;
+
+// The most often the joypad asks the host for new input while a frame is
+// being run (~1 ms of Gameboy time)
+const int JOYPAD_FETCH_CYCLES = 4096;
+
+// Memory layout
+// The hot state of an instance is kept in cache line aligned blocks, and
+// instances can be allocated from huge pages (see arena.h)
+const size_t CACHE_LINE_SIZE = 64;
+const size_t HUGE_PAGE_SIZE = 0x200000;
+
+// Memory budget
+// We want to be able to run thousands of instances at once, so each part of an
+// instance has a size budget which is checked at compile time (next to each
+// class). Measured on x86-64 (g++ 12):
+//   Mmu      ~76 KB - 8 KB VRAM, 8 KB WRAM, 512 B OAM/IO/HRAM, a 32 KB RAM
+//                     buffer (only used when there is no battery save mapped),
+//                     24 KB of decoded tiles (see tilecache.h) and the APU,
+//                     which is mostly its band-limited buffers, and the
+//                     joypad. The APU's sample buffer (32 KB) and the
+//                     joypad's input queue are allocated separately
+//   Core     ~192 B - registers, interrupt registers, counters, page table
+//   Cpu      ~16 B  - pointers to the MMU and core
+//   Display  ~27 KB - one byte (shade 0-3) per pixel, turned into RGB
+//                     only when the frame is presented, the sprites on
+//                     each line and the registers latched for each line
+//   Gameboy  ~240 B - component pointers, SDL handles and the PPU, which
+//                     with the pixel FIFO renderer holds the FIFOs and the
+//                     sprites on the current line
+// which is ~100 KB per instance, down from ~470 KB (plus a 2 MB ROM buffer)
+// The ROM is not part of an instance. It is allocated to its real size
+// (not CARTRIDGE_SIZE) in a cartridge image that every instance running the
+// same ROM shares (see cartridge.h)
+const int MMU_SIZE_BUDGET = 76 * 1024;
+const int CORE_SIZE_BUDGET = 4 * CACHE_LINE_SIZE;
+const int CPU_SIZE_BUDGET = 64;
+const int DISPLAY_SIZE_BUDGET = 28 * 1024;
+const int GAMEBOY_SIZE_BUDGET = 256;
+
 /* -------------------------Util Functions--------------------------- */
 
 template <typename T>
@@ -0,0 +1,35 @@
+/**
+ *
+ * VIDEO OBSERVER
+ * The display keeps its own copies of things derived from video registers
+ * and memory (i.e. palette lookup tables), so it needs to know when they are
+ * written. The MMU has no idea about the display, so the display registers
+ * itself with the MMU through this interface and is told about writes that
+ * matter to it
+ *
+ **/
+
+#ifndef __VIDEOOBSERVER_H_INCLUDED__
+#define __VIDEOOBSERVER_H_INCLUDED__
+
+#include "utils.h"
+
+class VideoObserver {
+
+    public:
+        virtual ~VideoObserver() {};
+
+        // One of the palette registers (BGP, OBP0, OBP1) was written
+        virtual void paletteChanged(Word address, Byte data) = 0;
+
+        // OAM was written, or a DMA transfer into it finished
+        virtual void spritesChanged() = 0;
+
+        // VRAM or OAM is about to be written at address
+        virtual void videoMemoryWillChange(Word address) = 0;
+
+        // All of VRAM and OAM was replaced (i.e. on reset)
+        virtual void videoMemoryReset() = 0;
+};
+
+#endif
@@ -0,0 +1,24 @@
+/**
+ *
+ * VIDEO SYNC
+ * The PPU doesn't run as the CPU does, only when it has to (see ppu.h). So
+ * before the CPU reads or writes anything the PPU uses or changes (the LCD
+ * registers, VRAM and OAM), the MMU asks it to catch up to the current cycle
+ * through this interface. Everything the PPU did up to then used the values
+ * from before the access
+ *
+ **/
+
+#ifndef __VIDEOSYNC_H_INCLUDED__
+#define __VIDEOSYNC_H_INCLUDED__
+
+class VideoSync {
+
+    public:
+        virtual ~VideoSync() {};
+
+        // Run the PPU up to the current cycle
+        virtual void catchUp() = 0;
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include <stdio.h>
+
+#include "wavwriter.h"
+#include "utils.h"
+
+using namespace std;
+
+// Write a value to the buffer as little-endian bytes
+static Byte *putLittleEndian(Byte *out, unsigned int value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+    {
+        *out++ = (value >> (i * 8)) & 0xFF;
+    }
+
+    return out;
+}
+
+WavWriter::~WavWriter()
+{
+    this->close();
+}
+
+bool WavWriter::open(const char *path, int sampleRate)
+{
+    this->close();
+
+    this->file = fopen(path, "wb");
+    if (this->file == NULL)
+    {
+        return false;
+    }
+
+    this->sampleRate = sampleRate;
+    this->framesWritten = 0;
+    this->stopping = false;
+    this->failed = false;
+    this->current.reserve(WAV_CHUNK_FRAMES);
+
+    // The sizes aren't known yet, so this is written again on close
+    if (!this->writeHeader())
+    {
+        fclose(this->file);
+        this->file = NULL;
+        return false;
+    }
+
+    this->writer = thread(&WavWriter::writeLoop, this);
+    return true;
+}
+
+bool WavWriter::isOpen()
+{
+    return this->file != NULL;
+}
+
+unsigned long long WavWriter::getFramesWritten()
+{
+    return this->framesWritten;
+}
+
+void WavWriter::write(const AudioFrame *frames, size_t count)
+{
+    if (this->file == NULL)
+    {
+        return;
+    }
+
+    this->framesWritten += count;
+    while (count > 0)
+    {
+        size_t space = WAV_CHUNK_FRAMES - this->current.size();
+        size_t taken = count < space ? count : space;
+        this->current.insert(this->current.end(), frames, frames + taken);
+        frames += taken;
+        count -= taken;
+
+        if (this->current.size() == (size_t) WAV_CHUNK_FRAMES)
+        {
+            this->queueChunk();
+        }
+    }
+}
+
+void WavWriter::queueChunk()
+{
+    // If the disk can't keep up, wait for it rather than queueing up more
+    // and more memory (or dropping samples)
+    unique_lock<mutex> lock(this->writeMutex);
+    while (this->pending.size() >= (size_t) WAV_QUEUE_CHUNKS)
+    {
+        this->chunkWritten.wait(lock);
+    }
+
+    this->pending.push_back(move(this->current));
+    this->current = vector<AudioFrame>();
+    this->current.reserve(WAV_CHUNK_FRAMES);
+    this->chunkReady.notify_one();
+}
+
+bool WavWriter::close()
+{
+    if (this->file == NULL)
+    {
+        return true;
+    }
+
+    // Hand over the last (partial) chunk, and let the thread finish
+    // everything that is queued
+    if (!this->current.empty())
+    {
+        this->queueChunk();
+    }
+
+    {
+        lock_guard<mutex> lock(this->writeMutex);
+        this->stopping = true;
+    }
+
+    this->chunkReady.notify_one();
+    this->writer.join();
+
+    // Now the sizes are known
+    bool ok = !this->failed && this->writeHeader();
+    ok = fclose(this->file) == 0 && ok;
+    this->file = NULL;
+    return ok;
+}
+
+void WavWriter::writeLoop()
+{
+    unique_lock<mutex> lock(this->writeMutex);
+    while (true)
+    {
+        while (this->pending.empty() && !this->stopping)
+        {
+            this->chunkReady.wait(lock);
+        }
+
+        if (this->pending.empty())
+        {
+            return;
+        }
+
+        vector<AudioFrame> chunk = move(this->pending.front());
+        this->pending.pop_front();
+
+        // Don't hold the lock while writing so the emulation thread can
+        // keep filling the next chunk
+        lock.unlock();
+        bool ok = this->writeChunk(chunk);
+        lock.lock();
+
+        this->failed = this->failed || !ok;
+        this->chunkWritten.notify_one();
+    }
+}
+
+bool WavWriter::writeChunk(const vector<AudioFrame> &chunk)
+{
+    // 4 bytes a frame, little-endian
+    vector<Byte> bytes(chunk.size() * 4);
+    Byte *out = bytes.data();
+    for (const AudioFrame &frame : chunk)
+    {
+        out = putLittleEndian(out, (Word) frame.left, 2);
+        out = putLittleEndian(out, (Word) frame.right, 2);
+    }
+
+    return fwrite(bytes.data(), 1, bytes.size(), this->file) == bytes.size();
+}
+
+bool WavWriter::writeHeader()
+{
+    // A RIFF file with a format chunk (PCM, 2 channels, 16 bits) and a data
+    // chunk holding the samples
+    unsigned int dataSize = (unsigned int) (this->framesWritten * 4);
+    Byte header[44];
+    Byte *out = header;
+
+    *out++ = 'R'; *out++ = 'I'; *out++ = 'F'; *out++ = 'F';
+    out = putLittleEndian(out, 36 + dataSize, 4);
+    *out++ = 'W'; *out++ = 'A'; *out++ = 'V'; *out++ = 'E';
+
+    *out++ = 'f'; *out++ = 'm'; *out++ = 't'; *out++ = ' ';
+    out = putLittleEndian(out, 16, 4);                     // Size of the format
+    out = putLittleEndian(out, 1, 2);                      // PCM
+    out = putLittleEndian(out, 2, 2);                      // Channels
+    out = putLittleEndian(out, this->sampleRate, 4);
+    out = putLittleEndian(out, this->sampleRate * 4, 4);   // Bytes per second
+    out = putLittleEndian(out, 4, 2);                      // Bytes per frame
+    out = putLittleEndian(out, 16, 2);                     // Bits per sample
+
+    *out++ = 'd'; *out++ = 'a'; *out++ = 't'; *out++ = 'a';
+    out = putLittleEndian(out, dataSize, 4);
+
+    // The header goes at the start. The samples carry on after it
+    long end = ftell(this->file);
+    fseek(this->file, 0, SEEK_SET);
+    bool ok = fwrite(header, 1, sizeof(header), this->file) == sizeof(header);
+    if (end > (long) sizeof(header))
+    {
+        fseek(this->file, end, SEEK_SET);
+    }
+
+    return ok;
+}
@@ -0,0 +1,77 @@
+/**
+ *
+ * WAV WRITER
+ * Writes audio (16-bit stereo) to a WAV file, for rendering the APU's output
+ * without an audio device (see Gameboy::renderAudio). The emulator runs much
+ * faster than real time when nothing is throttling it, so the file is
+ * written on a background thread - samples are copied into chunks, and full
+ * chunks are handed over to be written. Unlike the audio device, the writer
+ * never drops samples: if it falls too far behind, the emulator waits for it,
+ * so the file is always exactly what the APU made.
+ *
+ * The file is little-endian whatever the host is. The sizes in the header are
+ * filled in when it is closed
+ *
+ **/
+
+#ifndef __WAVWRITER_H_INCLUDED__
+#define __WAVWRITER_H_INCLUDED__
+
+#include <stdio.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "apu.h"
+#include "utils.h"
+
+class WavWriter {
+
+    public:
+        WavWriter() {};
+        ~WavWriter();
+
+        WavWriter(const WavWriter &) = delete;
+        WavWriter &operator=(const WavWriter &) = delete;
+
+        // Returns false if the file couldn't be created
+        bool open(const char *path, int sampleRate);
+
+        // Copy count frames into the file. Only blocks if the writing thread
+        // is a long way behind
+        void write(const AudioFrame *frames, size_t count);
+
+        // Write anything outstanding and finish the header. Blocks until
+        // everything is on disk. Returns false if anything failed to write
+        bool close();
+
+        bool isOpen();
+
+        // Frames written (or waiting to be) so far
+        unsigned long long getFramesWritten();
+
+    private:
+        FILE *file = NULL;
+        int sampleRate = 0;
+        unsigned long long framesWritten = 0;
+
+        // The chunk being filled, and full chunks waiting to be written
+        std::vector<AudioFrame> current;
+        std::deque<std::vector<AudioFrame>> pending;
+
+        std::thread writer;
+        std::mutex writeMutex;
+        std::condition_variable chunkReady;
+        std::condition_variable chunkWritten;
+        bool stopping = false;
+        bool failed = false;
+
+        void queueChunk();
+        void writeLoop();
+        bool writeChunk(const std::vector<AudioFrame> &chunk);
+        bool writeHeader();
+};
+
+#endif